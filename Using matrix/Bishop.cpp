@@ -33,14 +33,14 @@ int Bishop::validMove(int to_x, int to_y) {
     int directionX = (to_x - m_x) / dx;         // Direction on x-axis is -1 or 1
     int directionY = (to_y - m_y) / dy;         // Direction on y-axis is -1 or 1
     for (int i = 1; i < dx; i++) { // Check each square along the path
-        shared_ptr<ChessPiece> pathSquare = m_board->getChessBoard()(m_x + directionX * i, m_y + directionY * i);
+        shared_ptr<ChessPiece> & pathSquare = m_board->getChessBoard()(m_x + directionX * i, m_y + directionY * i);
         if (pathSquare != nullptr) {
             return 0; // Blocked by another piece
         }
     }
 
     // Check the final destination square
-    shared_ptr<ChessPiece> newSquare = m_board->getChessBoard()(to_x, to_y);
+    shared_ptr<ChessPiece> & newSquare = m_board->getChessBoard()(to_x, to_y);
     if (newSquare == nullptr) { // Non capturing. Empty square
         return 1; 
     } else if (newSquare->pieceIsWhite() != m_is_white) { // Capturing opponent's piece
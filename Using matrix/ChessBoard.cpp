@@ -17,9 +17,37 @@
 #include "Bishop.h"
 #include "Knight.h"
 #include "Pawn.h"
+#include "Random.h"
+#include "Zobrist.h"
+#include "Evaluation.h"
+#include "Nnue.h"
 
 using namespace std;
 
+// Copy constructor
+ChessBoard::ChessBoard(const ChessBoard & other) {
+    *this = other;
+}
+
+// Copy assignment. Pieces point to their board, so new pieces are created instead of sharing them
+ChessBoard & ChessBoard::operator=(const ChessBoard & other) {
+    if (this != &other) {
+        clear();
+        for (ChessPiece * piece : other.m_white_pieces) { // Keep the order of the vectors, so moves are generated in the same order
+            createBoard(piece->getX(), piece->getY(), piece->getLatin1Representation(), *this);
+        }
+        for (ChessPiece * piece : other.m_black_pieces) {
+            createBoard(piece->getX(), piece->getY(), piece->getLatin1Representation(), *this);
+        }
+        setWhiteToMove(other.m_white_to_move);
+        m_halfmove_clock = other.m_halfmove_clock;
+        m_fullmove_number = other.m_fullmove_number;
+        m_last_move = other.m_last_move;
+        m_last_move.piece = nullptr; // belongs to the other board
+    }
+    return *this;
+}
+
 // Given a valid move, the piece is moved from one square to another 
 void ChessBoard::movePiece(ChessMove chess_move) {
     shared_ptr<ChessPiece> &originalSquare = m_state(chess_move.from_x, chess_move.from_y);
@@ -29,11 +57,145 @@ void ChessBoard::movePiece(ChessMove chess_move) {
     if (newSquare != nullptr) {
         vector<ChessPiece*> &whiteOrBlackPieces = newSquare->m_is_white ? m_white_pieces : m_black_pieces;
         whiteOrBlackPieces.erase(remove(whiteOrBlackPieces.begin(), whiteOrBlackPieces.end(), newSquare.get()), whiteOrBlackPieces.end());
+        removePieceState(newSquare->latin1Representation(), chess_move.to_x, chess_move.to_y);
     }
+    char movingPiece = originalSquare->latin1Representation();
+    removePieceState(movingPiece, chess_move.from_x, chess_move.from_y);
+    addPieceState(movingPiece, chess_move.to_x, chess_move.to_y);
+
+    bool resetsClock = newSquare != nullptr || tolower(originalSquare->latin1Representation()) == 'p';
 
     newSquare = move(originalSquare); // transfer ownership of the shared pointer pointing to piece. 
     newSquare->m_x = chess_move.to_x; // move the piece from original to new square
     newSquare->m_y = chess_move.to_y;
+
+    // Update the game state. The other colour is to move next
+    m_halfmove_clock = resetsClock ? 0 : m_halfmove_clock + 1;
+    if (!newSquare->m_is_white) {
+        m_fullmove_number++;
+    }
+    setWhiteToMove(!newSquare->m_is_white);
+    m_last_move = chess_move;
+}
+
+// Every piece placed on or removed from a square goes through these
+void ChessBoard::addPieceState(char piece, int x, int y) {
+    m_hash ^= zobristPiece(piece, x, y);
+    m_psq_score += pieceSquareScore(piece, x, y);
+    if (m_accumulator != nullptr) m_accumulator->addPiece(piece, x, y);
+}
+
+void ChessBoard::removePieceState(char piece, int x, int y) {
+    m_hash ^= zobristPiece(piece, x, y);
+    m_psq_score -= pieceSquareScore(piece, x, y);
+    if (m_accumulator != nullptr) m_accumulator->removePiece(piece, x, y);
+}
+
+void ChessBoard::setAccumulator(NnueAccumulator * accumulator) {
+    m_accumulator = accumulator;
+    if (m_accumulator != nullptr) {
+        m_accumulator->reset();
+        for (ChessPiece * piece : m_white_pieces) m_accumulator->addPiece(piece->getLatin1Representation(), piece->getX(), piece->getY());
+        for (ChessPiece * piece : m_black_pieces) m_accumulator->addPiece(piece->getLatin1Representation(), piece->getX(), piece->getY());
+    }
+}
+
+// Set the side to move and keep the hash up to date
+void ChessBoard::setWhiteToMove(bool is_white) {
+    if (is_white != m_white_to_move) {
+        m_hash ^= zobristBlackToMove();
+    }
+    m_white_to_move = is_white;
+}
+
+// Moves the piece and promotes a pawn if the move has a promotion.
+// Returns what is needed to take the move back with unmakeMove()
+UndoInfo ChessBoard::makeMove(const ChessMove & chess_move) {
+    UndoInfo undo;
+    undo.move = chess_move;
+    undo.white_to_move = m_white_to_move;
+    undo.halfmove_clock = m_halfmove_clock;
+    undo.fullmove_number = m_fullmove_number;
+    undo.last_move = m_last_move;
+
+    // Remember the captured piece and its place in the vector so the order of moves is restored too
+    undo.captured = m_state(chess_move.to_x, chess_move.to_y);
+    if (undo.captured != nullptr) {
+        vector<ChessPiece*> &pieces = undo.captured->pieceIsWhite() ? m_white_pieces : m_black_pieces;
+        undo.captured_index = find(pieces.begin(), pieces.end(), undo.captured.get()) - pieces.begin();
+    }
+
+    movePiece(chess_move);
+    if (chess_move.promotion != '\0') {
+        undo.pawn = m_state(chess_move.to_x, chess_move.to_y);
+        promote(chess_move.to_x, chess_move.to_y, chess_move.promotion);
+    }
+    return undo;
+}
+
+// Takes back the last move made with makeMove()
+void ChessBoard::unmakeMove(const UndoInfo & undo) {
+    const ChessMove & m = undo.move;
+
+    // Put the pawn back in place of the promoted piece
+    if (undo.pawn != nullptr) {
+        ChessPiece * promoted = m_state(m.to_x, m.to_y).get();
+        vector<ChessPiece*> &pieces = undo.pawn->pieceIsWhite() ? m_white_pieces : m_black_pieces;
+        replace(pieces.begin(), pieces.end(), promoted, undo.pawn.get());
+        removePieceState(promoted->getLatin1Representation(), m.to_x, m.to_y);
+        addPieceState(undo.pawn->getLatin1Representation(), m.to_x, m.to_y);
+        m_state(m.to_x, m.to_y) = undo.pawn;
+    }
+
+    movePiece(ChessMove{m.to_x, m.to_y, m.from_x, m.from_y, nullptr}); // the original square is empty, so this never captures
+
+    if (undo.captured != nullptr) {
+        vector<ChessPiece*> &pieces = undo.captured->pieceIsWhite() ? m_white_pieces : m_black_pieces;
+        pieces.insert(pieces.begin() + undo.captured_index, undo.captured.get());
+        addPieceState(undo.captured->getLatin1Representation(), m.to_x, m.to_y);
+        m_state(m.to_x, m.to_y) = undo.captured;
+    }
+
+    setWhiteToMove(undo.white_to_move);
+    m_halfmove_clock = undo.halfmove_clock;
+    m_fullmove_number = undo.fullmove_number;
+    m_last_move = undo.last_move;
+}
+
+// All moves the given colour may play, in the order of the pieces. Capturing is compulsory,
+// so these are the capturing moves if there are any. The vector is reused to avoid allocations
+void ChessBoard::generateMoves(bool is_white, vector<ChessMove> & moves) {
+    moves.clear();
+    bool hasCapture = false;
+    for (ChessPiece * piece : is_white ? m_white_pieces : m_black_pieces) {
+        piece->addLegalMoves(moves, hasCapture);
+    }
+
+    // A pawn reaching the last row has one move per promotion piece
+    int lastRow = is_white ? 0 : 7;
+    size_t nrMoves = moves.size();
+    for (size_t i = 0; i < nrMoves; i++) {
+        if (moves[i].to_x == lastRow && tolower(moves[i].piece->getLatin1Representation()) == 'p') {
+            moves[i].promotion = 'n';
+            for (char pieceType : {'b', 'r', 'q'}) {
+                ChessMove promotionMove = moves[i];
+                promotionMove.promotion = pieceType;
+                moves.push_back(promotionMove);
+            }
+        }
+    }
+}
+
+// Legal moves sorted by squares and promotion piece, so the order only depends on the position
+vector<ChessMove> ChessBoard::legalMoves(bool is_white) {
+    vector<ChessMove> moves;
+    generateMoves(is_white, moves);
+
+    auto key = [](const ChessMove & m) {
+        return ((m.from_x * 8 + m.from_y) * 64 + m.to_x * 8 + m.to_y) * 8 + (m.promotion ? string("nbrq").find(m.promotion) + 1 : 0);
+    };
+    sort(moves.begin(), moves.end(), [&](const ChessMove & a, const ChessMove & b) { return key(a) < key(b); });
+    return moves;
 }
 
 // Get vector of all capturing moves for a given colour
@@ -91,6 +253,7 @@ void ChessBoard::createBoard(int x, int y, char pieceAsChar, ChessBoard &cb) {
     }
 
     cb.getChessBoard()(x, y) = newPiece; // Pointer given a posiiton on the board
+    cb.addPieceState(pieceAsChar, x, y);
     
     if (isWhite) { // Add piece to vector of given colour 
         cb.getWhitePieces().push_back(newPiece.get());  
@@ -99,6 +262,62 @@ void ChessBoard::createBoard(int x, int y, char pieceAsChar, ChessBoard &cb) {
     }
 }
 
+// Remove all pieces and reset the game state
+void ChessBoard::clear() {
+    for (auto & square : m_state) {
+        square = nullptr;
+    }
+    m_white_pieces.clear();
+    m_black_pieces.clear();
+    m_white_to_move = true;
+    m_halfmove_clock = 0;
+    m_fullmove_number = 1;
+    m_hash = 0;
+    m_psq_score = 0;
+    if (m_accumulator != nullptr) m_accumulator->reset();
+}
+
+// Replace the board with a parsed FEN/EPD position
+void ChessBoard::setPosition(const FenPosition & position) {
+    clear();
+    for (int x = 0; x < 8; x++) {
+        for (int y = 0; y < 8; y++) {
+            if (position.squares[x][y] != '.') {
+                createBoard(x, y, position.squares[x][y], *this);
+            }
+        }
+    }
+    setWhiteToMove(position.white_to_move);
+    m_halfmove_clock = position.halfmove_clock;
+    m_fullmove_number = position.fullmove_number;
+}
+
+// Get the board and game state as a FEN/EPD position
+FenPosition ChessBoard::getPosition() {
+    FenPosition position;
+    for (int x = 0; x < 8; x++) {
+        for (int y = 0; y < 8; y++) {
+            position.squares[x][y] = m_state(x, y) != nullptr ? m_state(x, y)->getLatin1Representation() : '.';
+        }
+    }
+    position.white_to_move = m_white_to_move;
+    position.halfmove_clock = m_halfmove_clock;
+    position.fullmove_number = m_fullmove_number;
+    return position;
+}
+
+void ChessBoard::setFen(const string & fen) {
+    FenPosition position;
+    if (!parseFen(fen, position)) {
+        throw invalid_argument("Invalid FEN: " + fen);
+    }
+    setPosition(position);
+}
+
+string ChessBoard::getFen() {
+    return writeFen(getPosition());
+}
+
 // Input operator 
 ChessBoard & operator>>(istream &is, ChessBoard &cb) {
     string line;
@@ -145,6 +364,16 @@ ChessBoard & operator<<(ostream &os, ChessBoard &cb) {
     return cb;
 }
 
+// Random numbers for the AIs, seeded once per thread. Seeding again on every move would repeat the same choices within a second
+static Xoshiro256 & aiRandom() {
+    thread_local Xoshiro256 generator((uint64_t(random_device()()) << 32) ^ random_device()());
+    return generator;
+}
+
+void ChessBoard::seedAI(uint64_t seed) {
+    aiRandom() = Xoshiro256(seed);
+}
+
 // Helper method used for pawn promotion. Creates a shared pointer based on given piece and colour
 shared_ptr<ChessPiece> createPiece(int pieceType, int x, int y, bool is_white, ChessBoard* cb) {
     if (pieceType == 0) return make_shared<Knight>(x, y, is_white, cb);
@@ -154,6 +383,26 @@ shared_ptr<ChessPiece> createPiece(int pieceType, int x, int y, bool is_white, C
     return nullptr;
 }
 
+// Replace the pawn on a square with a new piece of the given type ('n', 'b', 'r' or 'q')
+void ChessBoard::promote(int x, int y, char pieceType) {
+    shared_ptr<ChessPiece> &square = m_state(x, y);
+    ChessPiece * pawn = square.get();
+    bool is_white = pawn->pieceIsWhite();
+
+    size_t type = string("nbrq").find(pieceType);
+    if (type == string::npos) {
+        throw invalid_argument("Unidentified character!");
+    }
+    shared_ptr<ChessPiece> newPiece = createPiece(type, x, y, is_white, this);
+
+    vector<ChessPiece*> &pieces = is_white ? m_white_pieces : m_black_pieces;
+    replace(pieces.begin(), pieces.end(), pawn, newPiece.get()); // keep the position in the vector
+    removePieceState(pawn->getLatin1Representation(), x, y);
+    addPieceState(newPiece->getLatin1Representation(), x, y);
+    square = newPiece;
+    m_last_move.promotion = pieceType;
+}
+
 // Helper method for smart AI's pawn promotion. Checks if the piece on a given square has no capturing moves
 bool ChessBoard::noCapturingMovesForSquare(int x, int y, bool is_white){
     if((this -> getChessBoard()(x,y)->capturingMoves()).empty()){ 
@@ -183,7 +432,7 @@ bool ChessBoard::promotePawn(int x, int y, ChessMove move, bool is_white, bool i
         }
     }
     // Random AI randomly promotes. The smart AI also randomly promotes if all the above pieces had capturing moves. 
-    int newPiece = rand() % 4; 
+    int newPiece = aiRandom().below(4); 
     this -> getChessBoard()(x,y) = createPiece(newPiece, x, y, is_white, this);
     return true;  
 }
@@ -194,7 +443,11 @@ bool ChessBoard::checkPawnPromotion(ChessMove move, bool is_white, bool is_smart
     char pieceType = tolower(move.piece->getLatin1Representation());
 
     if(pieceType == 'p' && move.to_x == lastRow){ // The piece is a pawn that has reached the last row
+        char pawn = move.piece->getLatin1Representation();
         promotePawn(move.to_x,move.to_y,move,is_white, is_smart);   // Promote the pawn
+        char promoted = this->getChessBoard()(move.to_x, move.to_y)->getLatin1Representation();
+        removePieceState(pawn, move.to_x, move.to_y);
+        addPieceState(promoted, move.to_x, move.to_y);
         
         // Replace the pawn with the new piece
         vector<ChessPiece*> &pieces = is_white ? this->m_white_pieces : this->m_black_pieces;
@@ -203,6 +456,7 @@ bool ChessBoard::checkPawnPromotion(ChessMove move, bool is_white, bool is_smart
         if (iter != pieces.end()) {
             *iter = this->getChessBoard()(move.to_x, move.to_y).get(); // Find the correct square and replace the pawn with the new piece
         }
+        m_last_move.promotion = tolower(this->getChessBoard()(move.to_x, move.to_y)->getLatin1Representation());
         return true;
     } 
     else {
@@ -210,16 +464,9 @@ bool ChessBoard::checkPawnPromotion(ChessMove move, bool is_white, bool is_smart
     }
 }
 
-// Helper method for checking for forced capturing moves. Creates a copy of board by utilising the input and output streams. 
+// Helper method for checking for forced capturing moves. Creates a copy of board with the copy constructor. 
 unique_ptr<ChessBoard> copyChessBoard(ChessBoard& originalBoard) {
-    
-    stringstream ss;
-    ss << originalBoard; // Send board to stream
-
-    unique_ptr<ChessBoard> copiedBoard = make_unique<ChessBoard>(); 
-    ss >> *copiedBoard; // Create new board (createBoard() is called)
-
-    return copiedBoard;
+    return make_unique<ChessBoard>(originalBoard);
 }
 
 // Checks if the given move forces the opponent to capture the piece. Used by smart AI. 
@@ -243,16 +490,14 @@ bool ChessBoard::randomAI(bool is_white){
     vector<ChessMove> vecNonCapMoves = nonCapturingMoves(is_white);
     vector<ChessMove> vecCapMoves = capturingMoves(is_white);
 
-	srand((unsigned) time(NULL));
-
     if(!vecCapMoves.empty()){   // There are capturing moves
-        int randomIndex = rand() % (vecCapMoves.size());
+        int randomIndex = aiRandom().below(vecCapMoves.size());
         movePiece(vecCapMoves[randomIndex]);
         checkPawnPromotion(vecCapMoves[randomIndex], is_white, false);
         return true;
     }
     else if(!vecNonCapMoves.empty()) { // There are only non capturing moves
-        int randomIndex = rand() % (vecNonCapMoves.size()); 
+        int randomIndex = aiRandom().below(vecNonCapMoves.size()); 
         movePiece(vecNonCapMoves[randomIndex]);
         checkPawnPromotion(vecNonCapMoves[randomIndex], is_white, false);
         return true;
@@ -265,8 +510,6 @@ bool ChessBoard::randomAI(bool is_white){
 bool ChessBoard::smartAI(bool is_white){
     vector<ChessMove> vecNonCapMoves = nonCapturingMoves(is_white);
     vector<ChessMove> vecCapMoves = capturingMoves(is_white);
-	srand((unsigned) time(NULL));
-
     // Find and a make a smart move that forces the opponent to capture. 
     // If capturing moves available, go through them. Otherwise use non capturing moves
     vector<ChessMove>& chosenMoves = !vecCapMoves.empty() ? vecCapMoves : vecNonCapMoves;
@@ -280,11 +523,11 @@ bool ChessBoard::smartAI(bool is_white){
 
     // If no smart moves available, choose a random move
     if (!chosenMoves.empty()) {
-        int randomIndex = rand() % chosenMoves.size();
+        int randomIndex = aiRandom().below(chosenMoves.size());
         movePiece(chosenMoves[randomIndex]);
         checkPawnPromotion(chosenMoves[randomIndex], is_white, true);
         return true;
     }
 
     return false; // No moves possible -> Lose the game
-}
\ No newline at end of file
+}
@@ -13,11 +13,25 @@
 #include <istream>
 #include <memory>
 #include "ChessMove.h"
+#include "Fen.h"
 #include "Matrix.h"   
 
 using namespace std;
 
 class ChessPiece;
+struct NnueAccumulator;
+
+// Everything needed to take back a move
+struct UndoInfo {
+    ChessMove move;
+    shared_ptr<ChessPiece> captured;    // captured piece, if any
+    size_t captured_index = 0;          // its position in the vector of its colour
+    shared_ptr<ChessPiece> pawn;        // pawn replaced by a promotion, if any
+    bool white_to_move;
+    int halfmove_clock;
+    int fullmove_number;
+    ChessMove last_move;
+};
 
 class ChessBoard {
 
@@ -27,12 +41,30 @@ private:
     vector<ChessPiece *> m_white_pieces;
     vector<ChessPiece *> m_black_pieces;
 
+    // Game state that is not visible on the board itself
+    bool m_white_to_move = true;
+    int m_halfmove_clock = 0;       // moves since the last capture or pawn move
+    int m_fullmove_number = 1;
+    ChessMove m_last_move{-1, -1, -1, -1, nullptr};
+    uint64_t m_hash = 0;            // Zobrist hash, updated with every change of the board
+    int m_psq_score = 0;            // material and piece-square score from white's point of view, updated like the hash
+    NnueAccumulator * m_accumulator = nullptr;  // inputs of the network evaluation, if one is in use
+
+    // Keep the hash and the incremental evaluations up to date when a piece is placed on or removed from a square
+    void addPieceState(char piece, int x, int y);
+    void removePieceState(char piece, int x, int y);
+
     // Alternative 2 (the vectors own the chess pieces):
     // Matrix<ChessPiece *> m_state; 
     // vector<shared_ptr<ChessPiece>> m_white_pieces;
     // vector<shared_ptr<ChessPiece>> m_black_pieces;
 
 public:
+    // Constructors. A copy gets its own pieces, in the same order as the original
+    ChessBoard() = default;
+    ChessBoard(const ChessBoard & other);
+    ChessBoard & operator=(const ChessBoard & other);
+
     // Public getters
     Matrix<shared_ptr<ChessPiece>> & getChessBoard(){ 
         return m_state; 
@@ -43,14 +75,36 @@ public:
     vector<ChessPiece *>& getBlackPieces(){
         return m_black_pieces;
     };
+    const ChessMove & getLastMove() const { return m_last_move; }
+    bool whiteToMove() const { return m_white_to_move; }
+    void setWhiteToMove(bool is_white);
+    uint64_t getHash() const { return m_hash; }
+    int getPsqScore() const { return m_psq_score; }
+    // Keep the accumulator up to date with the pieces from now on. It is filled first. nullptr to stop
+    void setAccumulator(NnueAccumulator * accumulator);
+    int getHalfmoveClock() const { return m_halfmove_clock; }
 
     
     void movePiece(ChessMove chess_move);
+    UndoInfo makeMove(const ChessMove & chess_move);
+    void unmakeMove(const UndoInfo & undo);
+    void promote(int x, int y, char pieceType);
+    void generateMoves(bool is_white, vector<ChessMove> & moves);
+    vector<ChessMove> legalMoves(bool is_white);
     vector<ChessMove> capturingMoves(bool is_white);
     vector<ChessMove> nonCapturingMoves(bool is_white);
     void createBoard(int x, int y, char pieceAsChar,ChessBoard &cb);
+    void clear();
+
+    // FEN/EPD
+    void setPosition(const FenPosition & position);
+    FenPosition getPosition();
+    void setFen(const string & fen);
+    string getFen();
 
     bool randomAI(bool is_white);
+    // Seeds the random numbers of randomAI and smartAI on this thread, so their games can be repeated
+    static void seedAI(uint64_t seed);
     bool smartAI(bool is_white);
     bool checkPawnPromotion(ChessMove move, bool is_white, bool is_smart);
     bool promotePawn(int x, int y, ChessMove move, bool is_white, bool is_smart);
@@ -10,6 +10,8 @@
 #ifndef CHESSMOVE_H
 #define CHESSMOVE_H
 
+#include <string>
+
 using namespace std;
 
 class ChessPiece;
@@ -21,6 +23,14 @@ struct ChessMove {
     int to_y;
 
     ChessPiece * piece;   // change the position of the chess piece with this pointer.
+    char promotion = '\0'; // piece type a pawn promotes to ('n', 'b', 'r' or 'q'), '\0' if none
 };
 
+// Coordinate notation, for example "e2e4" or "a7a8q"
+inline string moveToString(const ChessMove & move) {
+    string text{char('a' + move.from_y), char('8' - move.from_x), char('a' + move.to_y), char('8' - move.to_x)};
+    if (move.promotion != '\0') text += move.promotion;
+    return text;
+}
+
 #endif //CHESSMOVE_H
@@ -63,3 +63,27 @@ vector<ChessMove> ChessPiece::nonCapturingMoves() {
     }
     return vecNonCapMoves;
 }
+
+// Add all legal moves of the piece in a single pass, calling validMove once per square
+void ChessPiece::addLegalMoves(vector<ChessMove> & moves, bool & hasCapture) {
+    for (int x = 0; x < 8; x++) { // Loop over all squares on the chessboard
+        for (int y = 0; y < 8; y++) {
+            // Every piece moves along a row, column or diagonal, or jumps like a knight
+            int dx = abs(x - m_x);
+            int dy = abs(y - m_y);
+            if (dx != 0 && dy != 0 && dx != dy && dx * dy != 2) {
+                continue;
+            }
+            int result = validMove(x, y);
+            if (result == 2) {
+                if (!hasCapture) { // First capture, the non capturing moves are no longer legal
+                    moves.clear();
+                    hasCapture = true;
+                }
+                moves.push_back(ChessMove{m_x, m_y, x, y, this});
+            } else if (result == 1 && !hasCapture) {
+                moves.push_back(ChessMove{m_x, m_y, x, y, this});
+            }
+        }
+    }
+}
@@ -45,6 +45,11 @@ public:
     bool nonCapturingMove(int to_x, int to_y);
     vector<ChessMove> capturingMoves();
     vector<ChessMove> nonCapturingMoves();
+    /**
+     * Adds the legal moves of this piece. Once a capturing move is found
+     * (hasCapture is set), non capturing moves are dropped since capturing is compulsory.
+     */
+    void addLegalMoves(vector<ChessMove> & moves, bool & hasCapture);
 
     /**
     * For testing multiple inheritance
@@ -52,6 +57,8 @@ public:
     int unnecessary_int;
 
     bool pieceIsWhite() { return m_is_white; }
+    int getX() const { return m_x; }
+    int getY() const { return m_y; }
     char getLatin1Representation() {
         return latin1Representation();
     }
@@ -0,0 +1,57 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the searching AIs
+*/
+
+#include "EngineAI.h"
+
+#include <iostream>
+
+using namespace std;
+
+// AI that searches several moves ahead with alpha-beta pruning
+bool searchAI(ChessBoard & cb, bool is_white, const SearchLimits & limits, Ponderer * ponderer) {
+    cb.setWhiteToMove(is_white);
+
+    // If the opponent played the expected reply, the search on its time carries on instead of a new one
+    SearchResult result;
+    bool ponderHit = ponderer != nullptr && ponderer->finish(cb.getLastMove(), limits, result);
+    if (!ponderHit) {
+        Search search(cb, searchTable(limits.hash_mb));
+        result = search.think(limits);
+    } else if (result.has_move) {
+        result.best_move.piece = cb.getChessBoard()(result.best_move.from_x, result.best_move.from_y).get(); // found on the ponder board
+    }
+
+    if (!result.has_move) {
+        return false; // No moves possible -> Lose the game
+    }
+    cb.makeMove(result.best_move);
+    cout << (ponderHit ? "Ponder hit. " : "") << "Searched to depth " << result.depth << ", " << result.nodes << " nodes in " << int(result.seconds * 1000) << " ms, "
+         << result.nodesPerSecond() << " nodes/s with " << result.threads << " threads, branching factor " << result.stats.branchingFactor()
+         << ", " << int(result.stats.ttHitRate() * 100) << "% table hits \n";
+    if (ponderer != nullptr) {
+        ponderer->start(cb, limits);
+    }
+    return true;
+}
+
+// AI that plays the move that wins most random games, found by Monte Carlo tree search
+bool mctsAI(ChessBoard & cb, bool is_white, Mcts & mcts, const MctsLimits & limits) {
+    cb.setWhiteToMove(is_white);
+
+    // The player keeps its tree between moves, so the playouts below the reply are used again
+    MctsResult result = mcts.think(cb, limits);
+
+    if (!result.has_move) {
+        return false; // No moves possible -> Lose the game
+    }
+    cb.makeMove(result.best_move);
+    cout << "Played " << result.playouts << " games (" << result.reused << " kept), " << result.playoutsPerSecond()
+         << " games/s with " << result.threads << " threads, win rate " << int(result.win_rate * 100) << "% \n";
+    return true;
+}
@@ -0,0 +1,29 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Searching AIs header file
+*/
+
+#ifndef ENGINEAI_H
+#define ENGINEAI_H
+
+#include "ChessBoard.h"
+#include "Mcts.h"
+#include "Ponder.h"
+#include "Search.h"
+
+using namespace std;
+
+// The AIs that search, kept apart from ChessBoard so tools that only need the board do not link the engines.
+// Each makes its move on the board and prints what it found. Returns false if the side has no moves, i.e. has won
+
+// Alpha-beta search. With a ponderer it goes on thinking on the opponent's time after its move
+bool searchAI(ChessBoard & cb, bool is_white, const SearchLimits & limits, Ponderer * ponderer = nullptr);
+
+// Monte Carlo tree search, with the tree of the player kept in mcts from one move to the next
+bool mctsAI(ChessBoard & cb, bool is_white, Mcts & mcts, const MctsLimits & limits);
+
+#endif //ENGINEAI_H
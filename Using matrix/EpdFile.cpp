@@ -0,0 +1,70 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of EpdFile
+*/
+
+#include "EpdFile.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+// Map the file and index the start of each record
+EpdFile::EpdFile(const string & path) : m_file(path) {
+    const char * first = m_file.begin();
+    const char * last = m_file.end();
+    const char * p = first;
+    while (p != last) {
+        const char * lineEnd = static_cast<const char *>(memchr(p, '\n', last - p));
+        if (lineEnd == nullptr) lineEnd = last;
+
+        const char * q = p;
+        while (q != lineEnd && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+        if (q != lineEnd && *q != '#') { // Skip empty lines and comments
+            m_record_starts.push_back(q - first);
+        }
+        p = (lineEnd == last) ? last : lineEnd + 1;
+    }
+}
+
+// Parse a given record
+void EpdFile::position(size_t index, FenPosition & position) const {
+    const char * first = m_file.begin() + m_record_starts.at(index);
+    const char * lineEnd = static_cast<const char *>(memchr(first, '\n', m_file.end() - first));
+    if (lineEnd == nullptr) lineEnd = m_file.end();
+
+    if (!parseFen(first, lineEnd, position)) {
+        throw invalid_argument("Invalid EPD record #" + to_string(index + 1) + ".");
+    }
+}
+
+// Claim the next record. The atomic cursor makes sure each record goes to exactly one thread
+bool EpdFile::next(FenPosition & position, size_t * index) {
+    size_t claimed = m_cursor.fetch_add(1, memory_order_relaxed);
+    if (claimed >= m_record_starts.size()) {
+        return false;
+    }
+    this->position(claimed, position);
+    if (index != nullptr) {
+        *index = claimed;
+    }
+    return true;
+}
+
+// Parse every record and write it back as FEN
+vector<string> loadFens(const string & path) {
+    EpdFile file(path);
+    vector<string> fens;
+    fens.reserve(file.size());
+    FenPosition position;
+    for (size_t i = 0; i < file.size(); i++) {
+        file.position(i, position);
+        fens.push_back(writeFen(position));
+    }
+    return fens;
+}
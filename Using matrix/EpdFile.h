@@ -0,0 +1,54 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Memory-mapped EPD/FEN file header file
+*/
+
+#ifndef EPDFILE_H
+#define EPDFILE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Fen.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+/**
+ * Read-only view of a file with one FEN/EPD record per line.
+ * Records are parsed straight from the mapped memory, so the
+ * operations of a parsed position point into the file and stay
+ * valid as long as the EpdFile exists.
+ */
+class EpdFile {
+public:
+    explicit EpdFile(const string & path);
+
+    // Number of records. Empty lines and lines starting with '#' are skipped
+    size_t size() const { return m_record_starts.size(); }
+
+    // Parse a given record. Throws invalid_argument if it is malformed
+    void position(size_t index, FenPosition & position) const;
+
+    // Hands out the next unclaimed record. Safe to call from several worker threads.
+    // Returns false when all records have been handed out
+    bool next(FenPosition & position, size_t * index = nullptr);
+    void rewind() { m_cursor = 0; }
+
+private:
+    MappedFile m_file;
+    vector<size_t> m_record_starts;     // offset of each record in the file
+    atomic<size_t> m_cursor{0};
+};
+
+/**
+ * Reads all records of a file as FEN, e.g. a list of openings. EPD operations are left out.
+ * Throws runtime_error if the file can not be opened and invalid_argument for a malformed record.
+ */
+vector<string> loadFens(const string & path);
+
+#endif //EPDFILE_H
@@ -0,0 +1,136 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the evaluation
+*/
+
+#include "Evaluation.h"
+#include "ChessBoard.h"
+#include "ChessPiece.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static const char pieceTypes[] = "pnbrqk";
+
+// The aim is to lose every piece, so owning one counts against a side.
+// Advanced pawns are close to promoting and central pieces are easier to offer to the opponent
+EvalParams::EvalParams() : material{100, 100, 110, 100, 120, 80}, psq{}, mobility(2), tempo(10) {
+    for (int x = 0; x < 8; x++) {
+        for (int y = 0; y < 8; y++) {
+            int centre = min(x, 7 - x) + min(y, 7 - y);
+            psq[0][x * 8 + y] = (x >= 1 && x <= 6) ? (6 - x) * 4 : 0;
+            psq[1][x * 8 + y] = 3 * centre;
+            psq[2][x * 8 + y] = 2 * centre;
+            psq[4][x * 8 + y] = 2 * centre;
+            psq[5][x * 8 + y] = 2 * centre;
+        }
+    }
+}
+
+// Material and table combined per piece character, so an update is a single lookup
+struct PieceSquareTable {
+    int scores[12][64];
+
+    void build(const EvalParams & params) {
+        for (int type = 0; type < 6; type++) {
+            for (int square = 0; square < 64; square++) {
+                int mirrored = (7 - square / 8) * 8 + square % 8;
+                scores[type][square] = params.psq[type][square] - params.material[type];
+                scores[type + 6][square] = params.material[type] - params.psq[type][mirrored];
+            }
+        }
+    }
+};
+
+static EvalParams params;
+static PieceSquareTable table = [] { PieceSquareTable t; t.build(params); return t; }();
+
+const EvalParams & evalParams() {
+    return params;
+}
+
+void setEvalParams(const EvalParams & newParams) {
+    params = newParams;
+    table.build(params);
+}
+
+EvalParams loadEvalParams(const string & path) {
+    ifstream file(path);
+    if (!file) {
+        throw invalid_argument("Could not open " + path + ".");
+    }
+    EvalParams loaded;
+    string line;
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string name;
+        if (!(fields >> name)) continue;
+        bool ok = true;
+        if (name == "material") {
+            for (int & value : loaded.material) ok = ok && (fields >> value);
+        } else if (name == "mobility") {
+            ok = static_cast<bool>(fields >> loaded.mobility);
+        } else if (name == "tempo") {
+            ok = static_cast<bool>(fields >> loaded.tempo);
+        } else if (name == "psq") {
+            char piece;
+            const char * type = (fields >> piece) ? strchr(pieceTypes, piece) : nullptr;
+            ok = type != nullptr && piece != '\0';
+            for (int square = 0; ok && square < 64; square++) ok = static_cast<bool>(fields >> loaded.psq[type - pieceTypes][square]);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            throw invalid_argument("Invalid evaluation line in " + path + ": " + line);
+        }
+    }
+    return loaded;
+}
+
+void saveEvalParams(const EvalParams & saved, const string & path) {
+    ofstream file(path, ios::trunc);
+    file << "material";
+    for (int value : saved.material) file << " " << value;
+    file << "\nmobility " << saved.mobility << "\ntempo " << saved.tempo << "\n";
+    for (int type = 0; type < 6; type++) {
+        file << "psq " << pieceTypes[type];
+        for (int value : saved.psq[type]) file << " " << value;
+        file << "\n";
+    }
+    if (!file) {
+        throw runtime_error("Could not write " + path + ".");
+    }
+}
+
+int pieceSquareScore(char piece, int x, int y) {
+    const char * type = strchr(pieceTypes, tolower(piece));
+    if (type == nullptr || piece == '\0') {
+        return 0;
+    }
+    return table.scores[(type - pieceTypes) + (isupper(piece) ? 0 : 6)][x * 8 + y];
+}
+
+int computePieceSquareScore(ChessBoard & cb) {
+    int score = 0;
+    for (ChessPiece * piece : cb.getWhitePieces()) {
+        score += pieceSquareScore(piece->getLatin1Representation(), piece->getX(), piece->getY());
+    }
+    for (ChessPiece * piece : cb.getBlackPieces()) {
+        score += pieceSquareScore(piece->getLatin1Representation(), piece->getX(), piece->getY());
+    }
+    return score;
+}
+
+int evaluatePosition(const ChessBoard & cb, int mobility) {
+    int score = cb.whiteToMove() ? cb.getPsqScore() : -cb.getPsqScore();
+    return score + params.tempo + params.mobility * mobility;
+}
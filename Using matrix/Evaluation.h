@@ -0,0 +1,49 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Evaluation header file
+*/
+
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+#include <string>
+
+using namespace std;
+
+class ChessBoard;
+
+// Weights of the static evaluation in centipawns
+struct EvalParams {
+    int material[6];        // p, n, b, r, q, k: what it costs to still own the piece
+    int psq[6][64];         // bonus for a white piece on [x * 8 + y]. Black pieces use the mirrored square
+    int mobility;           // per move of the side to move
+    int tempo;              // for the side to move
+
+    EvalParams();           // the default weights
+};
+
+const EvalParams & evalParams();
+
+// Replace the weights. Boards keep the piece-square score they have until their pieces are placed again
+void setEvalParams(const EvalParams & params);
+
+// Text file of weights, with lines "material p n b r q k", "mobility m", "tempo t" and "psq <piece> <64 squares>".
+// Weights missing from the file keep their default. Throws invalid_argument for a malformed file
+EvalParams loadEvalParams(const string & path);
+void saveEvalParams(const EvalParams & params, const string & path);
+
+// Material and piece-square value of a piece (latin1 character) on a square, from white's point of view.
+// ChessBoard adds and subtracts these as pieces move, so the sum is always ready
+int pieceSquareScore(char piece, int x, int y);
+
+// Sum of pieceSquareScore() over all pieces, to check the incremental score
+int computePieceSquareScore(ChessBoard & cb);
+
+// Static evaluation from the point of view of the side to move, which has the given number of moves
+int evaluatePosition(const ChessBoard & cb, int mobility);
+
+#endif //EVALUATION_H
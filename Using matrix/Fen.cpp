@@ -0,0 +1,151 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of FEN/EPD parsing and writing
+*/
+
+#include "Fen.h"
+
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+// Helper method. Finds the next space or tab separated field from p on and moves p past it.
+// Returns false if only spaces are left
+static bool nextField(const char * & p, const char * last, const char * & begin, const char * & end) {
+    while (p != last && (*p == ' ' || *p == '\t')) p++;
+    begin = p;
+    while (p != last && *p != ' ' && *p != '\t') p++;
+    end = p;
+    return begin != end;
+}
+
+static bool isPieceChar(char c) {
+    return c != '\0' && strchr("kqrbnpKQRBNP", c) != nullptr;
+}
+
+// Castling rights and en passant square, "-" when there are none
+static bool isCastlingField(const char * begin, const char * end) {
+    if (end - begin == 1 && *begin == '-') return true;
+    for (const char * p = begin; p != end; p++) {
+        if (*p == '\0' || strchr("KQkq", *p) == nullptr) return false;
+    }
+    return end - begin <= 4;
+}
+
+static bool isEnPassantField(const char * begin, const char * end) {
+    if (end - begin == 1 && *begin == '-') return true;
+    return end - begin == 2 && begin[0] >= 'a' && begin[0] <= 'h' && (begin[1] == '3' || begin[1] == '6');
+}
+
+// Parses a FEN or EPD record
+bool parseFen(const char * first, const char * last, FenPosition & position) {
+    // Strip line ending
+    while (last != first && (last[-1] == '\n' || last[-1] == '\r')) last--;
+
+    // 1. Piece placement
+    const char * p = first;
+    const char * begin;
+    const char * end;
+    if (!nextField(p, last, begin, end)) return false;
+    int row = 0;
+    int col = 0;
+    for (const char * q = begin; q != end; q++) {
+        char c = *q;
+        if (c == '/') {
+            if (col != 8 || row == 7) return false;
+            row++;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            if (col + (c - '0') > 8) return false;
+            for (int i = 0; i < c - '0'; i++) position.squares[row][col++] = '.';
+        } else if (isPieceChar(c)) {
+            if (col == 8) return false;
+            position.squares[row][col++] = c;
+        } else {
+            return false;
+        }
+    }
+    if (row != 7 || col != 8) return false;
+
+    // 2. Side to move
+    if (!nextField(p, last, begin, end) || end - begin != 1 || (*begin != 'w' && *begin != 'b')) return false;
+    position.white_to_move = (*begin == 'w');
+
+    // 3. Castling and en passant. Not used in this variant, and may be left out
+    const char * rest = p;
+    bool more = nextField(p, last, begin, end);
+    if (more && isCastlingField(begin, end)) {
+        rest = p;
+        more = nextField(p, last, begin, end);
+    }
+    if (more && isEnPassantField(begin, end)) {
+        rest = p;
+    }
+
+    // 4. Move counters (FEN) or operations (EPD)
+    position.halfmove_clock = 0;
+    position.fullmove_number = 1;
+    position.operations = nullptr;
+    position.operations_length = 0;
+
+    int counters[2];
+    int nrCounters = 0;
+    for (p = rest; nrCounters < 2 && nextField(p, last, begin, end); rest = p) {
+        auto result = from_chars(begin, end, counters[nrCounters]);
+        if (result.ec != errc() || result.ptr != end) break;   // not a number, the rest is EPD operations
+        if (counters[nrCounters] < 0) return false;
+        nrCounters++;
+    }
+    if (nrCounters > 0) position.halfmove_clock = counters[0];
+    if (nrCounters > 1) position.fullmove_number = counters[1];
+
+    while (rest != last && (*rest == ' ' || *rest == '\t')) rest++;
+    if (rest != last) {
+        position.operations = rest;
+        position.operations_length = last - rest;
+    }
+    return true;
+}
+
+// Writes the position as FEN
+size_t writeFen(const FenPosition & position, char * out) {
+    char * p = out;
+    for (int row = 0; row < 8; row++) {
+        int empty = 0;
+        for (int col = 0; col < 8; col++) {
+            char c = position.squares[row][col];
+            if (c == '.') {
+                empty++;
+                continue;
+            }
+            if (empty > 0) *p++ = '0' + empty;
+            empty = 0;
+            *p++ = c;
+        }
+        if (empty > 0) *p++ = '0' + empty;
+        if (row < 7) *p++ = '/';
+    }
+    *p++ = ' ';
+    *p++ = position.white_to_move ? 'w' : 'b';
+    memcpy(p, " - - ", 5);       // no castling or en passant in this variant
+    p += 5;
+    p = to_chars(p, p + 11, position.halfmove_clock).ptr;
+    *p++ = ' ';
+    p = to_chars(p, p + 11, position.fullmove_number).ptr;
+    return p - out;
+}
+
+bool parseFen(const string & fen, FenPosition & position) {
+    return parseFen(fen.data(), fen.data() + fen.size(), position);
+}
+
+string writeFen(const FenPosition & position) {
+    char buffer[112];
+    size_t length = writeFen(position, buffer);
+    return string(buffer, length);
+}
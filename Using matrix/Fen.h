@@ -0,0 +1,46 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  FEN/EPD header file
+*/
+
+#ifndef FEN_H
+#define FEN_H
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// A parsed FEN/EPD record. Plain data, so parsing never allocates
+struct FenPosition {
+    char squares[8][8];             // [row][column] as in ChessBoard, row 0 is rank 8. '.' for empty squares
+    bool white_to_move = true;
+    int halfmove_clock = 0;
+    int fullmove_number = 1;
+    const char * operations = nullptr;  // EPD operations (e.g. "bm e4; id \"x\";"), points into the parsed text
+    size_t operations_length = 0;
+};
+
+/**
+ * Parses a FEN or EPD record in [first, last).
+ * Fields are separated by spaces or tabs. Castling and en passant fields are accepted but
+ * ignored, since this variant has neither, and may be left out before the move counters.
+ * Returns false if the record is malformed, for example with a negative move counter.
+ */
+bool parseFen(const char * first, const char * last, FenPosition & position);
+
+/**
+ * Writes the position as FEN into out, which must hold at least 112 characters.
+ * Returns the number of characters written.
+ */
+size_t writeFen(const FenPosition & position, char * out);
+
+// Convenience versions using strings
+bool parseFen(const string & fen, FenPosition & position);
+string writeFen(const FenPosition & position);
+
+#endif //FEN_H
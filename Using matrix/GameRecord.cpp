@@ -0,0 +1,124 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the compressed game record
+*/
+
+#include "GameRecord.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+static const char fileMagic[8] = {'L', 'C', 'G', 'A', 'M', '0', '0', '1'};
+
+// Helper method. Same squares and promotion, the piece pointers belong to different boards
+static bool sameMove(const ChessMove & a, const ChessMove & b) {
+    return a.from_x == b.from_x && a.from_y == b.from_y && a.to_x == b.to_x && a.to_y == b.to_y && a.promotion == b.promotion;
+}
+
+GameRecorder::GameRecorder(ChessBoard & start) {
+    m_board.setPosition(start.getPosition());
+    m_record.start = packBoard(m_board);
+}
+
+// Find the index of the move among the legal moves and code it
+void GameRecorder::record(const ChessMove & move) {
+    vector<ChessMove> moves = m_board.legalMoves(m_board.whiteToMove());
+    size_t index = 0;
+    while (index < moves.size() && !sameMove(moves[index], move)) {
+        index++;
+    }
+    if (index == moves.size()) {
+        throw invalid_argument("Recorded move is not legal!");
+    }
+
+    if (moves.size() > 1) { // Forced moves are not stored at all
+        m_encoder.encode(index, 1, moves.size());
+    }
+    m_board.makeMove(moves[index]);
+    m_record.nr_moves++;
+}
+
+GameRecord GameRecorder::finish(int result) {
+    m_encoder.finish();
+    m_record.result = result;
+    return m_record;
+}
+
+// Decode the move indices and play them
+void replayGame(const GameRecord & record, ChessBoard & cb, const function<void(ChessBoard &, const ChessMove &)> & onMove) {
+    unpackBoard(record.start, cb);
+    RangeDecoder decoder(record.coded_moves.data(), record.coded_moves.size());
+
+    for (int i = 0; i < record.nr_moves; i++) {
+        vector<ChessMove> moves = cb.legalMoves(cb.whiteToMove());
+        if (moves.empty()) {
+            throw invalid_argument("Game record has more moves than the game!");
+        }
+        size_t index = 0;
+        if (moves.size() > 1) {
+            index = decoder.getFreq(moves.size());
+            decoder.decode(index, 1);
+        }
+        cb.makeMove(moves[index]);
+        if (onMove) {
+            onMove(cb, moves[index]);
+        }
+    }
+}
+
+// RECORD FILES
+// Each record is the packed start position, the number of moves, the result,
+// the number of coded bytes and then the coded bytes
+
+GameWriter::GameWriter(const string & path) : m_file(path, ios::binary | ios::trunc) {
+    if (!m_file) {
+        throw runtime_error("Could not open " + path + ".");
+    }
+    m_file.write(fileMagic, sizeof(fileMagic));
+}
+
+void GameWriter::write(const GameRecord & record) {
+    uint32_t length = record.coded_moves.size();
+    m_file.write(reinterpret_cast<const char *>(&record.start), sizeof(record.start));
+    m_file.write(reinterpret_cast<const char *>(&record.nr_moves), sizeof(record.nr_moves));
+    m_file.write(reinterpret_cast<const char *>(&record.result), sizeof(record.result));
+    m_file.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    m_file.write(reinterpret_cast<const char *>(record.coded_moves.data()), length);
+    m_file.flush();
+}
+
+GameReader::GameReader(const string & path) : m_file(path), m_offset(sizeof(fileMagic)) {
+    if (m_file.size() < sizeof(fileMagic) || memcmp(m_file.data(), fileMagic, sizeof(fileMagic)) != 0) {
+        throw invalid_argument(path + " is not a game file.");
+    }
+}
+
+bool GameReader::next(GameRecord & record) {
+    const size_t headerSize = sizeof(record.start) + sizeof(record.nr_moves) + sizeof(record.result) + sizeof(uint32_t);
+    if (m_offset + headerSize > m_file.size()) {
+        return false;
+    }
+    const char * p = m_file.data() + m_offset;
+    uint32_t length;
+    memcpy(&record.start, p, sizeof(record.start));
+    p += sizeof(record.start);
+    memcpy(&record.nr_moves, p, sizeof(record.nr_moves));
+    p += sizeof(record.nr_moves);
+    memcpy(&record.result, p, sizeof(record.result));
+    p += sizeof(record.result);
+    memcpy(&length, p, sizeof(length));
+    p += sizeof(length);
+
+    if (m_offset + headerSize + length > m_file.size()) {
+        throw invalid_argument("Game record is cut off!");
+    }
+    record.coded_moves.assign(p, p + length);
+    m_offset += headerSize + length;
+    return true;
+}
@@ -0,0 +1,82 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Compressed game record header file
+*/
+
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include "PackedPosition.h"
+#include "RangeCoder.h"
+
+using namespace std;
+
+/**
+ * A game stored as its start position and, for each move, the index of the
+ * move in ChessBoard::legalMoves(). The indices are range coded with a uniform
+ * model over the number of legal moves, so forced moves cost nothing and a
+ * move from n alternatives costs log2(n) bits.
+ */
+struct GameRecord {
+    PackedPosition start;
+    int8_t result = 0;              // 1 if white won, -1 if black won, 0 if unfinished
+    uint16_t nr_moves = 0;
+    vector<uint8_t> coded_moves;
+};
+
+// Records a game while it is played. Keeps its own copy of the board to find the move indices
+class GameRecorder {
+public:
+    explicit GameRecorder(ChessBoard & start);
+    GameRecorder(const GameRecorder & other) = delete;
+    GameRecorder & operator=(const GameRecorder & other) = delete;
+
+    // Add a move that has just been played on the real board. Throws invalid_argument if it is not legal
+    void record(const ChessMove & move);
+
+    // Finish the record. Nothing can be recorded afterwards
+    GameRecord finish(int result);
+
+private:
+    ChessBoard m_board;
+    GameRecord m_record;
+    RangeEncoder m_encoder{m_record.coded_moves};
+};
+
+// Plays a record on cb from its start position. onMove is called after each move
+void replayGame(const GameRecord & record, ChessBoard & cb, const function<void(ChessBoard &, const ChessMove &)> & onMove = nullptr);
+
+// Appends records to a file
+class GameWriter {
+public:
+    explicit GameWriter(const string & path);
+    void write(const GameRecord & record);
+
+private:
+    ofstream m_file;
+};
+
+// Reads records from a memory-mapped file in order
+class GameReader {
+public:
+    explicit GameReader(const string & path);
+    bool next(GameRecord & record);     // false at the end of the file
+
+private:
+    MappedFile m_file;
+    size_t m_offset;
+};
+
+#endif //GAMERECORD_H
@@ -23,7 +23,7 @@ int King::validMove(int to_x, int to_y){
 
     // Verifications to see whether King move is valid
     if ((dx * dy == 1) || (dx + dy == 1)) {         // one step in any direction
-        shared_ptr<ChessPiece> newSquare = m_board->getChessBoard()(to_x, to_y);
+        shared_ptr<ChessPiece> & newSquare = m_board->getChessBoard()(to_x, to_y);
 
         if (newSquare == nullptr) { // Move is to empty square
             return 1; 
@@ -24,7 +24,7 @@ int Knight::validMove(int to_x, int to_y){
 
    // Verifications to see whether Knight move is valid
    if ((dx * dx + dy * dy) == 5) { // 2 squares in any vertical/horisontal direction and 1 square in perpendicular direction
-      shared_ptr<ChessPiece> newSquare = m_board->getChessBoard()(to_x, to_y);
+      shared_ptr<ChessPiece> & newSquare = m_board->getChessBoard()(to_x, to_y);
 
       // Move captures an opponent's piece or moves to an empty square
       if (newSquare == nullptr) { // Move is to empty square
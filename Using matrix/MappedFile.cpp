@@ -0,0 +1,136 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of MappedFile
+*/
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const string & path, MappedAccess access) {
+    DWORD flags = access == accessSequential ? FILE_FLAG_SEQUENTIAL_SCAN : access == accessRandom ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        throw runtime_error("Could not open " + path + ".");
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(m_file, &fileSize);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    if (m_size == 0) { // Empty files can not be mapped
+        return;
+    }
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        unmap();
+        throw runtime_error("Could not map " + path + ".");
+    }
+    m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        unmap();
+        throw runtime_error("Could not map " + path + ".");
+    }
+}
+
+void MappedFile::unmap() {
+    if (m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr) CloseHandle(m_mapping);
+    if (m_file != nullptr) CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = m_file = nullptr;
+    m_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept : m_data(other.m_data), m_size(other.m_size), m_file(other.m_file), m_mapping(other.m_mapping) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_file = other.m_mapping = nullptr;
+}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_file = other.m_file;
+        m_mapping = other.m_mapping;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_file = other.m_mapping = nullptr;
+    }
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const string & path, MappedAccess access) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Could not open " + path + ".");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw runtime_error("Could not read size of " + path + ".");
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size > 0) { // Empty files can not be mapped
+        void * mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Could not map " + path + ".");
+        }
+        if (access != accessNormal) {
+            madvise(mapping, m_size, access == accessSequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        }
+        m_data = static_cast<const char *>(mapping);
+    }
+    close(fd); // The mapping stays valid after the descriptor is closed
+}
+
+void MappedFile::unmap() {
+    if (m_data != nullptr) {
+        munmap(const_cast<char *>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept : m_data(other.m_data), m_size(other.m_size) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_data = nullptr;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
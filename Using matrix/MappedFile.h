@@ -0,0 +1,51 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Read-only memory-mapped file header file
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// How a mapped file is going to be read, so the kernel can plan its read-ahead
+enum MappedAccess {
+    accessSequential,       // front to back, as by the bulk loaders
+    accessRandom,           // scattered lookups, as by the tablebases and the opening book
+    accessNormal
+};
+
+class MappedFile {
+public:
+    // Maps the whole file into memory, to be read as access says. Throws runtime_error if the file can not be opened
+    explicit MappedFile(const string & path, MappedAccess access = accessSequential);
+    MappedFile(const MappedFile & other) = delete;
+    MappedFile & operator=(const MappedFile & other) = delete;
+    MappedFile(MappedFile && other) noexcept;
+    MappedFile & operator=(MappedFile && other) noexcept;
+    ~MappedFile();
+
+    const char * data() const { return m_data; }
+    size_t size() const { return m_size; }
+    const char * begin() const { return m_data; }
+    const char * end() const { return m_data + m_size; }
+
+private:
+    void unmap();
+
+    const char * m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void * m_file = nullptr;
+    void * m_mapping = nullptr;
+#endif
+};
+
+#endif //MAPPEDFILE_H
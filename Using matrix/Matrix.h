@@ -60,9 +60,12 @@ public:
 
     // iterators
     typedef T* iterator;
+    typedef const T* const_iterator;
 
     iterator begin();
     iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
 
 private:
     size_t m_rows;
@@ -463,6 +466,18 @@ typename Matrix<T>::iterator Matrix<T>::end() {
     return m_vec + m_rows * m_cols;
 }
 
+// begin() - read only version
+template<typename T>
+typename Matrix<T>::const_iterator Matrix<T>::begin() const {
+    return m_vec;
+}
+
+// end() - read only version
+template<typename T>
+typename Matrix<T>::const_iterator Matrix<T>::end() const {
+    return m_vec + m_rows * m_cols;
+}
+
 // INPUT / OUTPUT
 
 // Input operator
@@ -0,0 +1,266 @@
+/*
+* Bulk input/output for the Matrix class
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Fast text parsing and writing based on from_chars/to_chars, and a binary
+  format with a small header followed by the raw contiguous elements. Both
+  work directly on memory buffers, so large files can be memory-mapped.
+*/
+
+#ifndef MATRIXIO_H
+#define MATRIXIO_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "Matrix.h"
+#include "MappedFile.h"
+
+// Header of the binary format. The elements follow in row-major order
+struct MatrixFileHeader {
+    char magic[4];              // "MTX1"
+    uint32_t elementSize;       // sizeof(T) of the stored matrix
+    uint64_t rows;
+    uint64_t cols;
+};
+
+// text format
+template<typename T>
+const char * parseMatrix(const char * first, const char * last, Matrix<T> & m);
+
+template<typename T>
+void writeMatrix(std::string & out, const Matrix<T> & m);
+
+template<typename T>
+void writeMatrix(std::ostream & os, const Matrix<T> & m);
+
+// binary format
+template<typename T>
+void saveBinary(std::ostream & os, const Matrix<T> & m);
+
+template<typename T>
+void loadBinary(const char * data, size_t size, Matrix<T> & m);
+
+template<typename T>
+void loadBinary(std::istream & is, Matrix<T> & m);
+
+// files
+template<typename T>
+void loadTextFile(const std::string & path, Matrix<T> & m);
+
+template<typename T>
+void loadBinaryFile(const std::string & path, Matrix<T> & m);
+
+//
+// Implementations
+//
+
+// Helpers for the text parser. Brackets count as white space to match operator>>
+inline bool isMatrixSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '[' || c == ']';
+}
+
+inline const char * skipMatrixSpace(const char * first, const char * last) {
+    while (first != last && isMatrixSpace(*first)) first++;
+    return first;
+}
+
+// Number of elements on the line starting at first. Returns the end of the line in lineEnd
+inline size_t countLineElements(const char * first, const char * last, const char * & lineEnd) {
+    lineEnd = static_cast<const char *>(memchr(first, '\n', last - first));
+    if (lineEnd == nullptr) lineEnd = last;
+
+    size_t count = 0;
+    const char * p = skipMatrixSpace(first, lineEnd);
+    while (p != lineEnd) {
+        while (p != lineEnd && !isMatrixSpace(*p)) p++;   // skip the token itself
+        count++;
+        p = skipMatrixSpace(p, lineEnd);
+    }
+    return count;
+}
+
+// Parse a matrix from a text buffer, in the same format as operator>>.
+// The dimensions are found in a first cheap pass so elements are parsed straight into the matrix.
+// Returns the end of the parsed input
+template<typename T>
+const char * parseMatrix(const char * first, const char * last, Matrix<T> & m) {
+    static_assert(std::is_arithmetic<T>::value, "parseMatrix requires an arithmetic element type");
+
+    // 1. Find rows and columns
+    size_t rows = 0;
+    size_t columns = 0;
+    for (const char * p = first; p != last; ) {
+        const char * lineEnd;
+        size_t count = countLineElements(p, last, lineEnd);
+        if (count > 0) {
+            if (rows == 0) columns = count;
+            rows++;
+        }
+        p = (lineEnd == last) ? last : lineEnd + 1;
+    }
+
+    // 2. Parse the elements
+    Matrix<T> result(rows, columns);
+    T * out = result.begin();
+    size_t row = 0;
+    const char * p = first;
+    while (p != last) {
+        const char * lineEnd = static_cast<const char *>(memchr(p, '\n', last - p));
+        if (lineEnd == nullptr) lineEnd = last;
+
+        size_t col = 0;
+        p = skipMatrixSpace(p, lineEnd);
+        while (p != lineEnd) {
+            if (col == columns) {
+                throw std::out_of_range("Wrong dimensions!");
+            }
+            if (*p == '+') p++;     // from_chars does not accept a leading plus sign
+            auto [next, error] = std::from_chars(p, lineEnd, out[row * columns + col]);
+            if (error != std::errc()) {
+                throw std::invalid_argument("Invalid matrix element at row " + std::to_string(row) + "!");
+            }
+            col++;
+            p = skipMatrixSpace(next, lineEnd);
+        }
+        if (col > 0) {
+            if (col != columns) {
+                throw std::out_of_range("Wrong dimensions!");
+            }
+            row++;
+        }
+        p = (lineEnd == last) ? last : lineEnd + 1;
+    }
+
+    m = std::move(result);
+    return p;
+}
+
+// Append one row in the format of operator<<, prefixed by "[ " or "  " and ended by " ]" or a newline
+template<typename T>
+void appendMatrixRow(std::string & out, const Matrix<T> & m, size_t i) {
+    char buffer[64];
+    out += (i == 0) ? "[ " : "  ";
+    const T * row = m.begin() + i * m.cols();
+    for (size_t j = 0; j < m.cols(); j++) {
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), row[j]);
+        out.append(buffer, result.ptr);
+        if (j < m.cols() - 1) {
+            out += ' ';
+        }
+    }
+    out += (i == m.rows() - 1) ? " ]" : "\n";
+}
+
+// Write a matrix in the same format as operator<<, appending to a string
+template<typename T>
+void writeMatrix(std::string & out, const Matrix<T> & m) {
+    static_assert(std::is_arithmetic<T>::value, "writeMatrix requires an arithmetic element type");
+    out.reserve(out.size() + m.rows() * m.cols() * 8);
+    for (size_t i = 0; i < m.rows(); i++) {
+        appendMatrixRow(out, m, i);
+    }
+}
+
+// Write a matrix to a stream in large blocks instead of element by element
+template<typename T>
+void writeMatrix(std::ostream & os, const Matrix<T> & m) {
+    static_assert(std::is_arithmetic<T>::value, "writeMatrix requires an arithmetic element type");
+    const size_t blockSize = 1 << 20;
+    std::string block;
+    block.reserve(blockSize + 4096);
+    for (size_t i = 0; i < m.rows(); i++) {
+        appendMatrixRow(block, m, i);
+        if (block.size() >= blockSize) {
+            os.write(block.data(), block.size());
+            block.clear();
+        }
+    }
+    os.write(block.data(), block.size());
+}
+
+// Save a matrix in the binary format
+template<typename T>
+void saveBinary(std::ostream & os, const Matrix<T> & m) {
+    static_assert(std::is_trivially_copyable<T>::value, "saveBinary requires a trivially copyable element type");
+    MatrixFileHeader header{{'M', 'T', 'X', '1'}, sizeof(T), m.rows(), m.cols()};
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(m.begin()), m.rows() * m.cols() * sizeof(T));
+}
+
+// Load a matrix in the binary format from a memory buffer
+template<typename T>
+void loadBinary(const char * data, size_t size, Matrix<T> & m) {
+    static_assert(std::is_trivially_copyable<T>::value, "loadBinary requires a trivially copyable element type");
+    MatrixFileHeader header;
+    if (size < sizeof(header)) {
+        throw std::invalid_argument("Binary matrix is missing its header!");
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "MTX1", 4) != 0 || header.elementSize != sizeof(T)) {
+        throw std::invalid_argument("Binary matrix has the wrong format!");
+    }
+    if (header.cols != 0 && header.rows > (size - sizeof(header)) / sizeof(T) / header.cols) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+
+    Matrix<T> result(header.rows, header.cols);
+    memcpy(result.begin(), data + sizeof(header), header.rows * header.cols * sizeof(T));
+    m = std::move(result);
+}
+
+// Load a matrix in the binary format from a stream
+template<typename T>
+void loadBinary(std::istream & is, Matrix<T> & m) {
+    static_assert(std::is_trivially_copyable<T>::value, "loadBinary requires a trivially copyable element type");
+    MatrixFileHeader header;
+    if (!is.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        throw std::invalid_argument("Binary matrix is missing its header!");
+    }
+    if (memcmp(header.magic, "MTX1", 4) != 0 || header.elementSize != sizeof(T)) {
+        throw std::invalid_argument("Binary matrix has the wrong format!");
+    }
+    if (header.cols != 0 && header.rows > SIZE_MAX / sizeof(T) / header.cols) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    size_t bytes = header.rows * header.cols * sizeof(T);
+
+    // A stream that can seek tells how much is left, so a bad header is found before allocating
+    std::streampos start = is.tellg();
+    if (start != std::streampos(-1) && is.seekg(0, std::ios::end)) {
+        std::streamoff remaining = is.tellg() - start;
+        is.seekg(start);
+        if (remaining < 0 || bytes > static_cast<uint64_t>(remaining)) {
+            throw std::out_of_range("Wrong dimensions!");
+        }
+    }
+    is.clear();
+
+    Matrix<T> result(header.rows, header.cols);
+    if (!is.read(reinterpret_cast<char *>(result.begin()), bytes)) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    m = std::move(result);
+}
+
+// Parse a text matrix from a memory-mapped file
+template<typename T>
+void loadTextFile(const std::string & path, Matrix<T> & m) {
+    MappedFile file(path);
+    parseMatrix(file.begin(), file.end(), m);
+}
+
+// Load a binary matrix from a memory-mapped file
+template<typename T>
+void loadBinaryFile(const std::string & path, Matrix<T> & m) {
+    MappedFile file(path);
+    loadBinary(file.data(), file.size(), m);
+}
+
+#endif //MATRIXIO_H
@@ -0,0 +1,197 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the Monte Carlo tree search
+*/
+
+#include "Mcts.h"
+#include "TranspositionTable.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+// Results are counted in half points, from the point of view of the side that made the move into a node
+struct Mcts::Node {
+    uint16_t move = 0;                  // packed move into this node
+    bool white_moved = false;           // colour that made the move
+    uint64_t hash = 0;                  // set when the node is expanded
+    atomic<uint32_t> visits{0};
+    atomic<uint64_t> half_points{0};
+    atomic<int> state{unexpanded};
+    vector<unique_ptr<Node>> children;  // written once, before state becomes expanded
+
+    enum { unexpanded, expanding, expanded };
+};
+
+// The move of a packed move on a given board
+static ChessMove unpackMove(uint16_t packed, ChessBoard & cb) {
+    ChessMove move{(packed & 63) / 8, packed & 7, ((packed >> 6) & 63) / 8, (packed >> 6) & 7, nullptr};
+    move.promotion = "\0nbrq"[(packed >> 12) & 7];
+    move.piece = cb.getChessBoard()(move.from_x, move.from_y).get();
+    return move;
+}
+
+Mcts::Mcts() = default;
+Mcts::~Mcts() = default;
+
+// UCT: the child with the best average result plus a bonus for children that have had few visits
+Mcts::Node * Mcts::select(Node * node, double exploration) {
+    double logVisits = log(double(node->visits.load(memory_order_relaxed)) + 1);
+    Node * best = nullptr;
+    double bestValue = -1;
+    for (unique_ptr<Node> & child : node->children) {
+        uint32_t visits = child->visits.load(memory_order_relaxed);
+        if (visits == 0) {
+            return child.get();
+        }
+        double value = child->half_points.load(memory_order_relaxed) / (2.0 * visits) + exploration * sqrt(logVisits / visits);
+        if (value > bestValue) {
+            bestValue = value;
+            best = child.get();
+        }
+    }
+    return best;
+}
+
+// One thread: select a leaf, expand it, play it out and pass the result back up, until stopped
+void Mcts::runPlayouts(ChessBoard & cb, const MctsLimits & limits, Playout & playout, atomic<bool> & stop, chrono::steady_clock::time_point deadline) {
+    vector<Node *> path;
+    vector<UndoInfo> undos;
+    vector<ChessMove> moves;
+    while (!stop.load(memory_order_relaxed)) {
+        // 1. Selection. Visits are added on the way down (virtual loss)
+        Node * node = m_root.get();
+        node->visits.fetch_add(1, memory_order_relaxed);
+        path.assign(1, node);
+        while (node->state.load(memory_order_acquire) == Node::expanded && !node->children.empty() && cb.getHalfmoveClock() < 100) {
+            node = select(node, limits.exploration);
+            node->visits.fetch_add(1, memory_order_relaxed);
+            path.push_back(node);
+            undos.push_back(cb.makeMove(unpackMove(node->move, cb)));
+        }
+
+        // 2. Expansion, by the first thread to get here
+        int expected = Node::unexpanded;
+        if (node->state.compare_exchange_strong(expected, Node::expanding, memory_order_acquire)) {
+            cb.generateMoves(cb.whiteToMove(), moves);
+            node->hash = cb.getHash();
+            node->children.reserve(moves.size());
+            for (const ChessMove & move : moves) {
+                node->children.push_back(make_unique<Node>());
+                node->children.back()->move = packMove(move);
+                node->children.back()->white_moved = cb.whiteToMove();
+            }
+            node->state.store(Node::expanded, memory_order_release);
+        }
+
+        // 3. Playout. A node without moves is won by the side to move
+        int result;
+        if (cb.getHalfmoveClock() >= 100) {
+            result = 0;
+        } else if (node->state.load(memory_order_acquire) == Node::expanded && node->children.empty()) {
+            result = cb.whiteToMove() ? 1 : -1;
+        } else {
+            result = playout.play(cb).result;
+        }
+
+        // 4. Backpropagation
+        for (Node * visited : path) {
+            int points = result == 0 ? 1 : ((result > 0) == visited->white_moved ? 2 : 0);
+            visited->half_points.fetch_add(points, memory_order_relaxed);
+        }
+        while (!undos.empty()) {
+            cb.unmakeMove(undos.back());
+            undos.pop_back();
+        }
+
+        uint64_t playouts = m_playouts.fetch_add(1, memory_order_relaxed) + 1;
+        if ((limits.playouts > 0 && playouts >= limits.playouts) || chrono::steady_clock::now() >= deadline) {
+            stop = true;
+        }
+    }
+}
+
+// Look for the position among the children and grandchildren of the old root
+bool Mcts::reuseTree(ChessBoard & cb) {
+    if (m_root == nullptr) {
+        return false;
+    }
+    uint64_t hash = cb.getHash();
+    if (m_root->hash == hash) {
+        return true;
+    }
+    for (unique_ptr<Node> & child : m_root->children) {
+        if (child->hash == hash) {
+            m_root = move(child);
+            return true;
+        }
+        for (unique_ptr<Node> & grandchild : child->children) {
+            if (grandchild->hash == hash) {
+                m_root = move(grandchild);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+MctsResult Mcts::think(ChessBoard & cb, const MctsLimits & limits) {
+    auto start = chrono::steady_clock::now();
+    MctsResult result;
+    result.threads = limits.threads > 1 ? limits.threads : 1;
+
+    if (!reuseTree(cb)) {
+        m_root = make_unique<Node>();
+        m_root->white_moved = !cb.whiteToMove();
+    }
+    result.reused = m_root->visits.load();
+    m_playouts = 0;
+
+    vector<ChessMove> moves;
+    cb.generateMoves(cb.whiteToMove(), moves);
+    if (moves.empty()) {
+        return result;
+    }
+
+    // Every helper gets its own board and random numbers
+    atomic<bool> stop{false};
+    vector<unique_ptr<ChessBoard>> boards;
+    vector<Playout> playouts;
+    random_device seed;
+    for (int i = 0; i < result.threads; i++) {
+        boards.push_back(make_unique<ChessBoard>(cb));
+        playouts.emplace_back((uint64_t(seed()) << 32) ^ seed());
+    }
+    auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(limits.seconds));
+    vector<thread> threads;
+    for (int i = 1; i < result.threads; i++) {
+        threads.emplace_back([&, i]() { runPlayouts(*boards[i], limits, playouts[i], stop, deadline); });
+    }
+    runPlayouts(*boards[0], limits, playouts[0], stop, deadline);
+    for (thread & helper : threads) {
+        helper.join();
+    }
+
+    // The move with the most visits is the most reliable
+    Node * best = nullptr;
+    for (unique_ptr<Node> & child : m_root->children) {
+        if (best == nullptr || child->visits > best->visits) {
+            best = child.get();
+        }
+    }
+    if (best != nullptr) {
+        result.has_move = true;
+        result.best_move = unpackMove(best->move, cb);
+        result.win_rate = best->visits > 0 ? best->half_points / (2.0 * best->visits) : 0;
+    }
+    result.playouts = m_playouts;
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
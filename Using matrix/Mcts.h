@@ -0,0 +1,71 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Monte Carlo tree search header file
+*/
+
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include "Playout.h"
+
+using namespace std;
+
+// How much the tree search may do for one move. It stops at whichever limit comes first
+struct MctsLimits {
+    double seconds = 1;
+    uint64_t playouts = 0;          // 0 for no limit
+    int threads = 1;
+    double exploration = 1.4;       // UCT exploration constant
+};
+
+struct MctsResult {
+    ChessMove best_move{-1, -1, -1, -1, nullptr};
+    bool has_move = false;          // false if the side to move has no moves, i.e. has won
+    double win_rate = 0;            // of the best move, draws count half
+    uint64_t playouts = 0;          // this search, all threads together
+    uint64_t reused = 0;            // visits kept from the previous search
+    double seconds = 0;
+    int threads = 1;
+
+    uint64_t playoutsPerSecond() const { return seconds > 0 ? uint64_t(playouts / seconds) : playouts; }
+};
+
+/**
+ * Monte Carlo tree search with UCT selection and random playouts (see Playout).
+ * Threads share one tree (tree parallelism). A thread descending the tree adds a visit
+ * to each node before its playout is done, which counts as a loss until the result
+ * comes in (virtual loss), so the other threads spread out over different lines.
+ * The tree is kept between moves: when the next position is found in the old tree,
+ * that part of the tree becomes the new root.
+ */
+class Mcts {
+public:
+    Mcts();
+    ~Mcts();
+
+    // Search the side to move of cb. The board is left unchanged
+    MctsResult think(ChessBoard & cb, const MctsLimits & limits);
+
+private:
+    struct Node;
+
+    bool reuseTree(ChessBoard & cb);
+    void runPlayouts(ChessBoard & cb, const MctsLimits & limits, Playout & playout, atomic<bool> & stop, chrono::steady_clock::time_point deadline);
+    Node * select(Node * node, double exploration);
+
+    unique_ptr<Node> m_root;
+    atomic<uint64_t> m_playouts{0};
+};
+
+#endif //MCTS_H
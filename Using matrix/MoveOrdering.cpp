@@ -0,0 +1,117 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of move ordering
+*/
+
+#include "MoveOrdering.h"
+#include "ChessPiece.h"
+#include "TranspositionTable.h"
+
+#include <cctype>
+#include <cstdlib>
+
+using namespace std;
+
+const int ttMoveScore = 1 << 30;
+const int captureScore = 1 << 24;
+const int killerScore = 1 << 22;
+const int counterMoveScore = 1 << 21;
+const int maxHistory = 1 << 16;     // history scores stay in [-maxHistory, maxHistory]
+
+MoveOrdering::MoveOrdering(int maxPly) : m_killers(2 * (maxPly + 1), 0) {}
+
+void MoveOrdering::newSearch() {
+    fill(m_killers.begin(), m_killers.end(), 0);
+    for (auto & colour : m_history) {
+        for (auto & from : colour) {
+            for (int & score : from) {
+                score /= 2;
+            }
+        }
+    }
+}
+
+// Usual piece values, used to decide which captures give away the most
+int MoveOrdering::pieceValue(char piece) {
+    switch (tolower(piece)) {
+        case 'p': return 1;
+        case 'n': return 3;
+        case 'b': return 3;
+        case 'r': return 5;
+        case 'q': return 9;
+        case 'k': return 4;
+    }
+    return 0;
+}
+
+void MoveOrdering::scoreMoves(ChessBoard & cb, const vector<ChessMove> & moves, vector<int> & scores, uint16_t ttMove, int ply) const {
+    const ChessMove & lastMove = cb.getLastMove();
+    uint16_t counterMove = lastMove.from_x >= 0 ? m_countermoves[lastMove.from_x * 8 + lastMove.from_y][lastMove.to_x * 8 + lastMove.to_y] : 0;
+    bool is_white = cb.whiteToMove();
+
+    scores.resize(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        const ChessMove & move = moves[i];
+        uint16_t packed = packMove(move);
+        shared_ptr<ChessPiece> & victim = cb.getChessBoard()(move.to_x, move.to_y);
+
+        if (packed == ttMove) {
+            scores[i] = ttMoveScore;
+        } else if (victim != nullptr) {
+            // Capture with the most valuable piece first, then take the least valuable piece
+            scores[i] = captureScore + 16 * pieceValue(move.piece->getLatin1Representation()) - pieceValue(victim->getLatin1Representation());
+        } else if (packed == m_killers[2 * ply]) {
+            scores[i] = killerScore + 1;
+        } else if (packed == m_killers[2 * ply + 1]) {
+            scores[i] = killerScore;
+        } else if (packed == counterMove) {
+            scores[i] = counterMoveScore;
+        } else {
+            scores[i] = history(is_white, move);
+        }
+    }
+}
+
+// Selection of the next move. Cheaper than sorting since most nodes cut off after a few moves
+void MoveOrdering::pickNext(vector<ChessMove> & moves, vector<int> & scores, size_t index) {
+    size_t best = index;
+    for (size_t i = index + 1; i < moves.size(); i++) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    if (best != index) {
+        swap(moves[index], moves[best]);
+        swap(scores[index], scores[best]);
+    }
+}
+
+// Reward the move that caused the cutoff and punish the moves searched before it
+void MoveOrdering::updateQuiet(ChessBoard & cb, const vector<ChessMove> & moves, size_t index, int depth, int ply) {
+    const ChessMove & move = moves[index];
+    uint16_t packed = packMove(move);
+    bool is_white = cb.whiteToMove();
+
+    if (m_killers[2 * ply] != packed) {
+        m_killers[2 * ply + 1] = m_killers[2 * ply];
+        m_killers[2 * ply] = packed;
+    }
+
+    const ChessMove & lastMove = cb.getLastMove();
+    if (lastMove.from_x >= 0) {
+        m_countermoves[lastMove.from_x * 8 + lastMove.from_y][lastMove.to_x * 8 + lastMove.to_y] = packed;
+    }
+
+    // Scores move towards +-maxHistory and never pass it
+    int bonus = depth * depth < 400 ? depth * depth : 400;
+    int & score = history(is_white, move);
+    score += bonus - score * bonus / maxHistory;
+    for (size_t i = 0; i < index; i++) {
+        int & failed = history(is_white, moves[i]);
+        failed -= bonus + failed * bonus / maxHistory;
+    }
+}
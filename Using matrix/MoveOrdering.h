@@ -0,0 +1,60 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Move ordering header file
+*/
+
+#ifndef MOVEORDERING_H
+#define MOVEORDERING_H
+
+#include <cstdint>
+#include <vector>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+
+using namespace std;
+
+/**
+ * Orders moves so that alpha-beta cutoffs come early:
+ * 1. the move from the transposition table
+ * 2. captures, the most valuable capturing piece first since that gives it away
+ * 3. killer moves that caused a cutoff at the same ply
+ * 4. the countermove to the opponent's last move
+ * 5. other non capturing moves by their history score
+ * Capturing is compulsory, so a position has either only captures or only non capturing moves.
+ */
+class MoveOrdering {
+public:
+    explicit MoveOrdering(int maxPly);
+
+    // Forget killers and age the history between searches
+    void newSearch();
+
+    // Score the moves of the position on cb. Higher scores are searched first
+    void scoreMoves(ChessBoard & cb, const vector<ChessMove> & moves, vector<int> & scores, uint16_t ttMove, int ply) const;
+
+    // Swap the best move from index onwards to index
+    static void pickNext(vector<ChessMove> & moves, vector<int> & scores, size_t index);
+
+    // A non capturing move caused a beta cutoff. The moves in moves[0, index) were searched before it without success
+    void updateQuiet(ChessBoard & cb, const vector<ChessMove> & moves, size_t index, int depth, int ply);
+
+    static int pieceValue(char piece);
+
+private:
+    int & history(bool is_white, const ChessMove & move) {
+        return m_history[is_white][move.from_x * 8 + move.from_y][move.to_x * 8 + move.to_y];
+    }
+    int history(bool is_white, const ChessMove & move) const {
+        return m_history[is_white][move.from_x * 8 + move.from_y][move.to_x * 8 + move.to_y];
+    }
+
+    vector<uint16_t> m_killers;     // two per ply
+    uint16_t m_countermoves[64][64] = {};   // indexed by the from and to square of the previous move
+    int m_history[2][64][64] = {};
+};
+
+#endif //MOVEORDERING_H
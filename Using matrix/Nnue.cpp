@@ -0,0 +1,228 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the neural network evaluation
+*/
+
+#include "Nnue.h"
+#include "MappedFile.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NNUE_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const char fileMagic[8] = {'L', 'C', 'N', 'N', 'U', 'E', '0', '1'};
+static const char pieceChars[] = "PNBRQKpnbrqk";
+
+int nnueFeature(int perspective, char piece, int x, int y) {
+    if (perspective == 1) { // black sees the board with the colours swapped and rank 1 at the top
+        piece = isupper(piece) ? tolower(piece) : toupper(piece);
+        x = 7 - x;
+    }
+    const char * type = strchr(pieceChars, piece);
+    if (type == nullptr || piece == '\0') {
+        return -1;
+    }
+    return (type - pieceChars) * 64 + x * 8 + y;
+}
+
+bool Nnue::hasAvx2() {
+#ifdef NNUE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#ifdef NNUE_AVX2
+__attribute__((target("avx2")))
+static void addWeightsAvx2(int16_t * values, const int16_t * weights, bool add) {
+    for (int i = 0; i < nnueHidden; i += 16) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i));
+        __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights + i));
+        v = add ? _mm256_add_epi16(v, w) : _mm256_sub_epi16(v, w);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(values + i), v);
+    }
+}
+
+// Clip both accumulators to [0, 127] as bytes, then multiply with the 8 bit weights.
+// maddubs adds pairs of products into 16 bits, which can not overflow since the inputs are at most 127
+__attribute__((target("avx2")))
+static void layer1Avx2(const NnueAccumulator & accumulator, int us, const NnueWeights & weights, int32_t * out) {
+    alignas(32) uint8_t input[2 * nnueHidden];
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(127);
+    for (int side = 0; side < 2; side++) {
+        const int16_t * values = accumulator.values[side == 0 ? us : 1 - us];
+        for (int i = 0; i < nnueHidden; i += 32) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i));
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(values + i + 16));
+            a = _mm256_min_epi16(_mm256_max_epi16(a, zero), max);
+            b = _mm256_min_epi16(_mm256_max_epi16(b, zero), max);
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(input + side * nnueHidden + i), packed);
+        }
+    }
+
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int j = 0; j < nnueLayer1; j++) {
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < 2 * nnueHidden; i += 32) {
+            __m256i in = _mm256_load_si256(reinterpret_cast<const __m256i *>(input + i));
+            __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i *>(weights.layer1_weights[j] + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        out[j] = _mm_cvtsi128_si32(s);
+    }
+}
+#endif
+
+static void addWeights(int16_t * values, const int16_t * weights, bool add) {
+#ifdef NNUE_AVX2
+    if (Nnue::hasAvx2()) {
+        addWeightsAvx2(values, weights, add);
+        return;
+    }
+#endif
+    for (int i = 0; i < nnueHidden; i++) {
+        values[i] += add ? weights[i] : -weights[i];
+    }
+}
+
+static void layer1Scalar(const NnueAccumulator & accumulator, int us, const NnueWeights & weights, int32_t * out) {
+    uint8_t input[2 * nnueHidden];
+    for (int side = 0; side < 2; side++) {
+        const int16_t * values = accumulator.values[side == 0 ? us : 1 - us];
+        for (int i = 0; i < nnueHidden; i++) {
+            input[side * nnueHidden + i] = static_cast<uint8_t>(clamp<int>(values[i], 0, 127));
+        }
+    }
+    for (int j = 0; j < nnueLayer1; j++) {
+        int32_t sum = 0;
+        for (int i = 0; i < 2 * nnueHidden; i++) {
+            sum += input[i] * weights.layer1_weights[j][i];
+        }
+        out[j] = sum;
+    }
+}
+
+// Bias, clipped ReLU and the output neuron. Shared by both versions so they give the same score
+static int outputLayer(const NnueWeights & weights, const int32_t * layer1) {
+    int32_t sum = weights.output_bias;
+    for (int j = 0; j < nnueLayer1; j++) {
+        int32_t hidden = clamp((layer1[j] + weights.layer1_bias[j]) >> 6, 0, 127);
+        sum += hidden * weights.output_weights[j];
+    }
+    return sum / nnueOutputScale;
+}
+
+void NnueAccumulator::reset() {
+    for (int side = 0; side < 2; side++) {
+        memcpy(values[side], weights->feature_bias, sizeof(values[side]));
+    }
+}
+
+void NnueAccumulator::addPiece(char piece, int x, int y) {
+    for (int side = 0; side < 2; side++) {
+        int feature = nnueFeature(side, piece, x, y);
+        if (feature >= 0) addWeights(values[side], weights->feature_weights[feature], true);
+    }
+}
+
+void NnueAccumulator::removePiece(char piece, int x, int y) {
+    for (int side = 0; side < 2; side++) {
+        int feature = nnueFeature(side, piece, x, y);
+        if (feature >= 0) addWeights(values[side], weights->feature_weights[feature], false);
+    }
+}
+
+Nnue::Nnue() : m_weights(make_unique<NnueWeights>()) {
+    memset(m_weights.get(), 0, sizeof(NnueWeights));
+}
+
+// The fields are stored one after the other, without the padding of the struct
+Nnue::Nnue(const string & path) : Nnue() {
+    MappedFile file(path);
+    NnueWeights & w = *m_weights;
+    const size_t size = sizeof(fileMagic) + sizeof(w.feature_weights) + sizeof(w.feature_bias) + sizeof(w.layer1_weights) +
+                        sizeof(w.layer1_bias) + sizeof(w.output_weights) + sizeof(w.output_bias);
+    if (file.size() != size || memcmp(file.data(), fileMagic, sizeof(fileMagic)) != 0) {
+        throw invalid_argument(path + " is not a network file.");
+    }
+    const char * p = file.data() + sizeof(fileMagic);
+    auto read = [&p](void * field, size_t bytes) {
+        memcpy(field, p, bytes);
+        p += bytes;
+    };
+    read(w.feature_weights, sizeof(w.feature_weights));
+    read(w.feature_bias, sizeof(w.feature_bias));
+    read(w.layer1_weights, sizeof(w.layer1_weights));
+    read(w.layer1_bias, sizeof(w.layer1_bias));
+    read(w.output_weights, sizeof(w.output_weights));
+    read(&w.output_bias, sizeof(w.output_bias));
+}
+
+void Nnue::save(const string & path) const {
+    ofstream file(path, ios::binary | ios::trunc);
+    const NnueWeights & w = *m_weights;
+    file.write(fileMagic, sizeof(fileMagic));
+    file.write(reinterpret_cast<const char *>(w.feature_weights), sizeof(w.feature_weights));
+    file.write(reinterpret_cast<const char *>(w.feature_bias), sizeof(w.feature_bias));
+    file.write(reinterpret_cast<const char *>(w.layer1_weights), sizeof(w.layer1_weights));
+    file.write(reinterpret_cast<const char *>(w.layer1_bias), sizeof(w.layer1_bias));
+    file.write(reinterpret_cast<const char *>(w.output_weights), sizeof(w.output_weights));
+    file.write(reinterpret_cast<const char *>(&w.output_bias), sizeof(w.output_bias));
+    if (!file) {
+        throw runtime_error("Could not write " + path + ".");
+    }
+}
+
+void Nnue::randomize(uint64_t seed) {
+    Xoshiro256 rng(seed);
+    auto small = [&rng](int range) { return static_cast<int>(rng.below(2 * range + 1)) - range; };
+    NnueWeights & w = *m_weights;
+    for (auto & row : w.feature_weights) {
+        for (int16_t & weight : row) weight = small(8);
+    }
+    for (int16_t & bias : w.feature_bias) bias = small(32) + 32;
+    for (auto & row : w.layer1_weights) {
+        for (int8_t & weight : row) weight = small(16);
+    }
+    for (int32_t & bias : w.layer1_bias) bias = small(256);
+    for (int8_t & weight : w.output_weights) weight = small(64);
+    w.output_bias = 0;
+}
+
+int Nnue::evaluate(const NnueAccumulator & accumulator, bool whiteToMove) const {
+#ifdef NNUE_AVX2
+    if (hasAvx2()) {
+        alignas(32) int32_t layer1[nnueLayer1];
+        layer1Avx2(accumulator, whiteToMove ? 0 : 1, *m_weights, layer1);
+        return outputLayer(*m_weights, layer1);
+    }
+#endif
+    return evaluateScalar(accumulator, whiteToMove);
+}
+
+int Nnue::evaluateScalar(const NnueAccumulator & accumulator, bool whiteToMove) const {
+    int32_t layer1[nnueLayer1];
+    layer1Scalar(accumulator, whiteToMove ? 0 : 1, *m_weights, layer1);
+    return outputLayer(*m_weights, layer1);
+}
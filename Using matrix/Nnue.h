@@ -0,0 +1,82 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Neural network evaluation header file
+*/
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+class ChessBoard;
+
+const int nnueInputs = 768;             // 12 piece types on 64 squares
+const int nnueHidden = 256;             // accumulator size of one perspective
+const int nnueLayer1 = 32;
+const int nnueOutputScale = 16;         // output units per centipawn
+
+// Weights of the network. Kept aligned for the vector instructions
+struct alignas(64) NnueWeights {
+    int16_t feature_weights[nnueInputs][nnueHidden];
+    int16_t feature_bias[nnueHidden];
+    int8_t layer1_weights[nnueLayer1][2 * nnueHidden];
+    int32_t layer1_bias[nnueLayer1];
+    int8_t output_weights[nnueLayer1];
+    int32_t output_bias;
+};
+
+/**
+ * Sums of the feature weights of all pieces, from both sides' point of view.
+ * A board with an accumulator adds and subtracts the weights of pieces as they
+ * are placed and removed, so making or taking back a move costs a few vector additions.
+ */
+struct alignas(64) NnueAccumulator {
+    int16_t values[2][nnueHidden];      // [0] from white's and [1] from black's point of view
+    const NnueWeights * weights = nullptr;
+
+    void reset();                       // the biases only, as for an empty board
+    void addPiece(char piece, int x, int y);
+    void removePiece(char piece, int x, int y);
+};
+
+/**
+ * A small quantized network (768 -> 2 x 256 -> 32 -> 1) in the style of NNUE.
+ * Each side sees the board from its own side, with the colours swapped and the rows mirrored
+ * for black. The two accumulators, the side to move first, are clipped to [0, 127] and go
+ * through one dense layer of 8 bit weights and a clipped ReLU to the output.
+ * The dense layers use AVX2 when the processor has it and plain loops otherwise.
+ *
+ * The file format is an 8 byte header "LCNNUE01" followed by NnueWeights in that order, little endian.
+ */
+class Nnue {
+public:
+    Nnue();                             // all weights 0
+    explicit Nnue(const string & path);
+
+    void save(const string & path) const;
+    void randomize(uint64_t seed);      // small random weights, a starting point for training
+    NnueWeights & weights() { return *m_weights; }
+    const NnueWeights & weights() const { return *m_weights; }
+
+    // Score in centipawns from the point of view of the side to move
+    int evaluate(const NnueAccumulator & accumulator, bool whiteToMove) const;
+    int evaluateScalar(const NnueAccumulator & accumulator, bool whiteToMove) const;
+
+    static bool hasAvx2();
+
+private:
+    unique_ptr<NnueWeights> m_weights;
+};
+
+// Feature of a piece on a square as seen by one side (0 white, 1 black). -1 for an unknown piece
+int nnueFeature(int perspective, char piece, int x, int y);
+
+#endif //NNUE_H
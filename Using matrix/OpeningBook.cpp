@@ -0,0 +1,219 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the opening book
+*/
+
+#include "OpeningBook.h"
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+
+using namespace std;
+
+static const char fileMagic[8] = {'L', 'C', 'B', 'O', 'O', 'K', '0', '1'};
+
+static bool entryLess(const BookEntry & a, const BookEntry & b) {
+    return a.key != b.key ? a.key < b.key : a.move < b.move;
+}
+
+// Add the statistics of b to a, if they belong to the same move
+static bool mergeEntry(BookEntry & a, const BookEntry & b) {
+    if (a.key != b.key || a.move != b.move) {
+        return false;
+    }
+    a.games += b.games;
+    a.wins += b.wins;
+    a.draws += b.draws;
+    return true;
+}
+
+BookBuilder::BookBuilder(const string & path, int maxPlies, size_t memoryMB) :
+    m_path(path), m_max_plies(maxPlies), m_max_entries(max<size_t>(memoryMB * 1024 * 1024 / sizeof(BookEntry), 1024)) {
+    m_entries.reserve(m_max_entries);
+}
+
+// Temporary runs are removed, also when the book was never finished
+BookBuilder::~BookBuilder() {
+    for (const string & run : m_runs) {
+        remove(run.c_str());
+    }
+}
+
+void BookBuilder::addGame(const GameRecord & record) {
+    unpackBoard(record.start, m_board);
+    uint64_t key = m_board.getHash();
+    int ply = 0;
+    replayGame(record, m_board, [&](ChessBoard & cb, const ChessMove & move) {
+        if (ply++ < m_max_plies) {
+            bool whiteMoved = !cb.whiteToMove();
+            BookEntry entry{key, packMove(move), 0, 1, 0, 0};
+            if (record.result == 0) {
+                entry.draws = 1;
+            } else if ((record.result > 0) == whiteMoved) {
+                entry.wins = 1;
+            }
+            m_entries.push_back(entry);
+            if (m_entries.size() >= m_max_entries) {
+                writeRun();
+            }
+        }
+        key = cb.getHash();
+    });
+}
+
+void BookBuilder::addGameFile(const string & path) {
+    GameReader reader(path);
+    GameRecord record;
+    while (reader.next(record)) {
+        addGame(record);
+    }
+}
+
+// Sort the entries in memory, merge those of the same move and write them as a run
+void BookBuilder::writeRun() {
+    sort(m_entries.begin(), m_entries.end(), entryLess);
+    size_t merged = 0;
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (merged == 0 || !mergeEntry(m_entries[merged - 1], m_entries[i])) {
+            m_entries[merged++] = m_entries[i];
+        }
+    }
+
+    string run = m_path + ".run" + to_string(m_runs.size());
+    ofstream file(run, ios::binary | ios::trunc);
+    file.write(reinterpret_cast<const char *>(m_entries.data()), merged * sizeof(BookEntry));
+    if (!file) {
+        throw runtime_error("Could not write " + run + ".");
+    }
+    m_runs.push_back(run);
+    m_entries.clear();
+}
+
+// Merge the runs with a heap over the first entry of each. Runs are read through memory mappings
+size_t BookBuilder::finish(uint32_t minGames) {
+    if (!m_entries.empty() || m_runs.empty()) {
+        writeRun();
+    }
+    vector<MappedFile> runs;
+    for (const string & run : m_runs) {
+        runs.emplace_back(run, accessSequential);   // each run is read front to back once
+    }
+
+    using Cursor = pair<const BookEntry *, const BookEntry *>;     // next entry and end of a run
+    auto later = [](const Cursor & a, const Cursor & b) { return entryLess(*b.first, *a.first); };
+    priority_queue<Cursor, vector<Cursor>, decltype(later)> heap(later);
+    for (const MappedFile & run : runs) {
+        const BookEntry * first = reinterpret_cast<const BookEntry *>(run.data());
+        if (run.size() >= sizeof(BookEntry)) {
+            heap.push({first, first + run.size() / sizeof(BookEntry)});
+        }
+    }
+
+    ofstream book(m_path, ios::binary | ios::trunc);
+    if (!book) {
+        throw runtime_error("Could not create " + m_path + ".");
+    }
+    book.write(fileMagic, sizeof(fileMagic));
+    vector<BookEntry> block;
+    block.reserve(4096);
+    size_t count = 0;
+    auto flush = [&]() {
+        book.write(reinterpret_cast<const char *>(block.data()), block.size() * sizeof(BookEntry));
+        block.clear();
+    };
+
+    BookEntry current{};
+    bool hasCurrent = false;
+    while (!heap.empty()) {
+        Cursor cursor = heap.top();
+        heap.pop();
+        if (!hasCurrent || !mergeEntry(current, *cursor.first)) {
+            if (hasCurrent && current.games >= minGames) {
+                block.push_back(current);
+                count++;
+                if (block.size() == 4096) flush();
+            }
+            current = *cursor.first;
+            hasCurrent = true;
+        }
+        if (++cursor.first != cursor.second) {
+            heap.push(cursor);
+        }
+    }
+    if (hasCurrent && current.games >= minGames) {
+        block.push_back(current);
+        count++;
+    }
+    flush();
+    if (!book) {
+        throw runtime_error("Could not write " + m_path + ".");
+    }
+
+    runs.clear();
+    for (const string & run : m_runs) {
+        remove(run.c_str());
+    }
+    m_runs.clear();
+    return count;
+}
+
+OpeningBook::OpeningBook(const string & path) : m_file(make_unique<MappedFile>(path, accessRandom)) {
+    if (m_file->size() < sizeof(fileMagic) || memcmp(m_file->data(), fileMagic, sizeof(fileMagic)) != 0 ||
+        (m_file->size() - sizeof(fileMagic)) % sizeof(BookEntry) != 0) {
+        throw invalid_argument(path + " is not an opening book.");
+    }
+    m_entries = reinterpret_cast<const BookEntry *>(m_file->data() + sizeof(fileMagic));
+    m_size = (m_file->size() - sizeof(fileMagic)) / sizeof(BookEntry);
+}
+
+pair<const BookEntry *, const BookEntry *> OpeningBook::probe(uint64_t key) const {
+    const BookEntry * first = lower_bound(m_entries, m_entries + m_size, key, [](const BookEntry & entry, uint64_t k) { return entry.key < k; });
+    const BookEntry * last = first;
+    while (last != m_entries + m_size && last->key == key) {
+        last++;
+    }
+    return {first, last};
+}
+
+bool OpeningBook::pickMove(ChessBoard & cb, Xoshiro256 & rng, ChessMove & move) const {
+    auto [first, last] = probe(cb.getHash());
+    if (first == last) {
+        return false;
+    }
+    vector<ChessMove> moves;
+    cb.generateMoves(cb.whiteToMove(), moves);
+
+    // Only moves that are legal here count, in case of a hash collision
+    vector<pair<ChessMove, uint32_t>> candidates;
+    uint64_t total = 0;
+    for (const BookEntry * entry = first; entry != last; entry++) {
+        for (const ChessMove & legal : moves) {
+            if (packMove(legal) == entry->move) {
+                candidates.push_back({legal, entry->games});
+                total += entry->games;
+                break;
+            }
+        }
+    }
+    if (total == 0) {
+        return false;
+    }
+    uint64_t pick = rng.next() % total;
+    for (const auto & candidate : candidates) {
+        if (pick < candidate.second) {
+            move = candidate.first;
+            return true;
+        }
+        pick -= candidate.second;
+    }
+    return false;
+}
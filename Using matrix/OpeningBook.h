@@ -0,0 +1,85 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Opening book header file
+*/
+
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include "GameRecord.h"
+#include "MappedFile.h"
+#include "Random.h"
+
+using namespace std;
+
+// Statistics of one move in one position. Books are sorted by key and then move
+struct BookEntry {
+    uint64_t key;           // Zobrist hash of the position
+    uint16_t move;          // packed with packMove()
+    uint16_t reserved;
+    uint32_t games;
+    uint32_t wins;          // for the side that played the move
+    uint32_t draws;         // including unfinished games
+};
+static_assert(sizeof(BookEntry) == 24, "BookEntry must be 24 bytes");
+
+/**
+ * Builds a book from game records that need not fit in memory.
+ * Every move of the first plies of a game becomes an entry with one game. When the
+ * entries fill the memory budget they are sorted, merged and written as a sorted run
+ * to a temporary file. finish() merges all runs into the book (external sort).
+ */
+class BookBuilder {
+public:
+    BookBuilder(const string & path, int maxPlies, size_t memoryMB = 256);
+    ~BookBuilder();
+
+    void addGame(const GameRecord & record);
+    void addGameFile(const string & path);     // every record of a file written by GameWriter
+
+    // Write the book, leaving out moves played in fewer than minGames games. Returns the number of entries
+    size_t finish(uint32_t minGames = 1);
+
+private:
+    void writeRun();
+
+    string m_path;
+    int m_max_plies;
+    size_t m_max_entries;
+    vector<BookEntry> m_entries;
+    vector<string> m_runs;
+    ChessBoard m_board;
+};
+
+/**
+ * A book file mapped into memory. Positions are found by binary search on the key.
+ */
+class OpeningBook {
+public:
+    OpeningBook() = default;
+    explicit OpeningBook(const string & path);
+
+    size_t size() const { return m_size; }
+
+    // The entries of a position, or an empty range
+    pair<const BookEntry *, const BookEntry *> probe(uint64_t key) const;
+
+    // A legal move of the side to move on cb, chosen at random in proportion to the games it was played in
+    bool pickMove(ChessBoard & cb, Xoshiro256 & rng, ChessMove & move) const;
+
+private:
+    unique_ptr<MappedFile> m_file;
+    const BookEntry * m_entries = nullptr;
+    size_t m_size = 0;
+};
+
+#endif //OPENINGBOOK_H
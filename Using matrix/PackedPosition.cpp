@@ -0,0 +1,119 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the compact binary position format
+*/
+
+#include "PackedPosition.h"
+#include "ChessBoard.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+static const char fileMagic[8] = {'L', 'C', 'P', 'O', 'S', '0', '0', '1'};
+static const char pieceCodes[] = "pnbrqk";  // index is the 3 bit piece type
+
+// Helper method. 4-bit code of a piece character, white pieces are uppercase
+static uint8_t pieceCode(char piece) {
+    const char * type = strchr(pieceCodes, tolower(piece));
+    if (type == nullptr || piece == '\0') {
+        throw invalid_argument("Unidentified character!");
+    }
+    return static_cast<uint8_t>(type - pieceCodes) | (islower(piece) ? 8 : 0);
+}
+
+// Piece character of a 4-bit code. Types 6 and 7 are not used, so the record is corrupt
+static char pieceChar(uint8_t code) {
+    if ((code & 7) >= 6) {
+        throw invalid_argument("Corrupt piece code!");
+    }
+    char piece = pieceCodes[code & 7];
+    return (code & 8) ? piece : toupper(piece);
+}
+
+// Encode a position. Squares are visited in the same order as the occupancy bits
+void packPosition(const FenPosition & position, PackedPosition & packed) {
+    memset(&packed, 0, sizeof(packed));
+    int nrPieces = 0;
+    for (int square = 0; square < 64; square++) {
+        char piece = position.squares[square / 8][square % 8];
+        if (piece == '.') continue;
+        if (nrPieces == maxPackedPieces) {
+            throw invalid_argument("Too many pieces to pack!");
+        }
+        packed.occupancy |= uint64_t(1) << square;
+        packed.pieces[nrPieces / 2] |= pieceCode(piece) << (4 * (nrPieces % 2));
+        nrPieces++;
+    }
+    int clock = position.halfmove_clock < 127 ? position.halfmove_clock : 127;
+    packed.flags = static_cast<uint8_t>((clock << 1) | (position.white_to_move ? 1 : 0));
+}
+
+// Decode a position. The full move number is not stored and becomes 1
+void unpackPosition(const PackedPosition & packed, FenPosition & position) {
+    int nrPieces = 0;
+    for (int square = 0; square < 64; square++) {
+        char & target = position.squares[square / 8][square % 8];
+        if (packed.occupancy & (uint64_t(1) << square)) {
+            if (nrPieces == maxPackedPieces) {
+                throw invalid_argument("Too many pieces to unpack!");
+            }
+            target = pieceChar((packed.pieces[nrPieces / 2] >> (4 * (nrPieces % 2))) & 15);
+            nrPieces++;
+        } else {
+            target = '.';
+        }
+    }
+    position.white_to_move = packed.flags & 1;
+    position.halfmove_clock = packed.flags >> 1;
+    position.fullmove_number = 1;
+    position.operations = nullptr;
+    position.operations_length = 0;
+}
+
+PackedPosition packBoard(ChessBoard & cb) {
+    PackedPosition packed;
+    packPosition(cb.getPosition(), packed);
+    return packed;
+}
+
+void unpackBoard(const PackedPosition & packed, ChessBoard & cb) {
+    FenPosition position;
+    unpackPosition(packed, position);
+    cb.setPosition(position);
+}
+
+// RECORD FILES
+
+PositionWriter::PositionWriter(const string & path) : m_file(path, ios::binary | ios::trunc) {
+    if (!m_file) {
+        throw runtime_error("Could not open " + path + ".");
+    }
+    m_file.write(fileMagic, sizeof(fileMagic));
+}
+
+void PositionWriter::write(const PackedPosition & packed) {
+    m_file.write(reinterpret_cast<const char *>(&packed), sizeof(packed));
+    m_count++;
+}
+
+PositionReader::PositionReader(const string & path) : m_file(path, accessRandom) {
+    if (m_file.size() < sizeof(fileMagic) || memcmp(m_file.data(), fileMagic, sizeof(fileMagic)) != 0) {
+        throw invalid_argument(path + " is not a position file.");
+    }
+    m_size = (m_file.size() - sizeof(fileMagic)) / sizeof(PackedPosition);
+}
+
+PackedPosition PositionReader::operator[](size_t index) const {
+    if (index >= m_size) {
+        throw out_of_range("Position index out of range!");
+    }
+    PackedPosition packed;
+    memcpy(&packed, m_file.data() + sizeof(fileMagic) + index * sizeof(PackedPosition), sizeof(packed));
+    return packed;
+}
@@ -0,0 +1,76 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Compact binary position format header file
+*/
+
+#ifndef PACKEDPOSITION_H
+#define PACKEDPOSITION_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "Fen.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+class ChessBoard;
+
+/**
+ * Fixed-size 32 byte position.
+ * Bit (row * 8 + column) of occupancy is set for each occupied square, and the
+ * pieces on those squares follow as 4-bit codes in the same order. Code bit 3 is
+ * set for black pieces, bits 0-2 hold the piece type (pawn, knight, bishop, rook, queen, king).
+ * Flags bit 0 is set when white is to move, bits 1-7 hold the halfmove clock (capped at 127).
+ */
+struct PackedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[23];     // room for 46 pieces
+    uint8_t flags;
+};
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must be 32 bytes");
+
+const int maxPackedPieces = 46;
+
+// Throws invalid_argument if the position has more than maxPackedPieces pieces
+void packPosition(const FenPosition & position, PackedPosition & packed);
+// Throws invalid_argument for a corrupt position: an unused piece code or too many pieces
+void unpackPosition(const PackedPosition & packed, FenPosition & position);
+
+PackedPosition packBoard(ChessBoard & cb);
+void unpackBoard(const PackedPosition & packed, ChessBoard & cb);
+
+/**
+ * Writes a record file: an 8 byte header followed by PackedPosition records.
+ */
+class PositionWriter {
+public:
+    explicit PositionWriter(const string & path);
+    void write(const PackedPosition & packed);
+    size_t count() const { return m_count; }
+    void flush() { m_file.flush(); }
+
+private:
+    ofstream m_file;
+    size_t m_count = 0;
+};
+
+/**
+ * Reads a record file through a memory mapping.
+ */
+class PositionReader {
+public:
+    explicit PositionReader(const string & path);
+    size_t size() const { return m_size; }
+    PackedPosition operator[](size_t index) const;
+
+private:
+    MappedFile m_file;
+    size_t m_size;
+};
+
+#endif //PACKEDPOSITION_H
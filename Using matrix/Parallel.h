@@ -0,0 +1,65 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Thread pool helpers header file
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Runs worker(threadId) on the given number of threads. The calling thread is thread 0.
+ * An exception in any worker calls stop(), so the others can finish early, and is
+ * thrown again once all threads have finished.
+ */
+template<typename Worker, typename Stop>
+void runThreads(int threads, Worker worker, Stop stop) {
+    threads = max(threads, 1);
+    vector<exception_ptr> errors(threads);
+    auto run = [&](int threadId) {
+        try {
+            worker(threadId);
+        } catch (...) {
+            errors[threadId] = current_exception();
+            stop();
+        }
+    };
+    vector<thread> helpers;
+    for (int i = 1; i < threads; i++) {
+        helpers.emplace_back(run, i);
+    }
+    run(0);
+    for (thread & helper : helpers) {
+        helper.join();
+    }
+    for (exception_ptr & error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+/**
+ * Runs work(begin, end, threadId) over [0, size) in chunks of the given size, shared out
+ * between the threads as they finish. An exception stops the others as in runThreads.
+ */
+template<typename Work>
+void parallelFor(size_t size, int threads, size_t chunk, Work work) {
+    atomic<size_t> next{0};
+    runThreads(threads, [&](int threadId) {
+        for (size_t begin = next.fetch_add(chunk); begin < size; begin = next.fetch_add(chunk)) {
+            work(begin, min(begin + chunk, size), threadId);
+        }
+    }, [&]() { next = size; });
+}
+
+#endif //PARALLEL_H
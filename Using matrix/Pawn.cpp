@@ -20,7 +20,7 @@ using namespace std;
  */
 // NOTE: x represents row, y represents column. 
 int Pawn::validMove(int to_x, int to_y){
-    shared_ptr<ChessPiece> newSquare = m_board->getChessBoard()(to_x, to_y);
+    shared_ptr<ChessPiece> & newSquare = m_board->getChessBoard()(to_x, to_y);
 
     int direction = m_is_white ? -1 : 1; // white moves up (-), black moves down (+)
     
@@ -0,0 +1,65 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the random playouts
+*/
+
+#include "Playout.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+using namespace std;
+
+Playout::Playout(uint64_t seed) : m_rng(seed) {
+    m_undos.reserve(256);
+}
+
+PlayoutResult Playout::play(ChessBoard & cb, int maxPlies) {
+    PlayoutResult result;
+    for (; result.plies < maxPlies && cb.getHalfmoveClock() < 100; result.plies++) {
+        cb.generateMoves(cb.whiteToMove(), m_moves);
+        if (m_moves.empty()) { // The side to move has no moves and wins
+            result.result = cb.whiteToMove() ? 1 : -1;
+            break;
+        }
+        m_undos.push_back(cb.makeMove(m_moves[m_rng.below(m_moves.size())]));
+    }
+    while (!m_undos.empty()) {
+        cb.unmakeMove(m_undos.back());
+        m_undos.pop_back();
+    }
+    return result;
+}
+
+PlayoutStats runPlayouts(ChessBoard & cb, uint64_t games, int threads, uint64_t seed) {
+    auto start = chrono::steady_clock::now();
+    PlayoutStats stats;
+    stats.threads = threads > 1 ? threads : 1;
+
+    // Every thread gets its own board and random numbers
+    atomic<uint64_t> next{0};
+    atomic<uint64_t> plies{0};
+    vector<unique_ptr<ChessBoard>> boards;
+    for (int i = 0; i < stats.threads; i++) {
+        boards.push_back(make_unique<ChessBoard>(cb));
+    }
+    runThreads(stats.threads, [&](int threadId) {
+        Playout playout(seed + threadId);
+        uint64_t threadPlies = 0;
+        while (next.fetch_add(1, memory_order_relaxed) < games) {
+            threadPlies += playout.play(*boards[threadId]).plies;
+        }
+        plies += threadPlies;
+    }, [&]() { next = games; });
+
+    stats.games = games;
+    stats.plies = plies;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
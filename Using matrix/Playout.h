@@ -0,0 +1,58 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Random playout header file
+*/
+
+#ifndef PLAYOUT_H
+#define PLAYOUT_H
+
+#include <cstdint>
+#include <vector>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include "Random.h"
+
+using namespace std;
+
+struct PlayoutResult {
+    int result = 0;             // 1 if white wins, -1 if black wins, 0 for a draw
+    int plies = 0;
+};
+
+struct PlayoutStats {
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    double seconds = 0;
+    int threads = 1;
+
+    uint64_t gamesPerSecond() const { return seconds > 0 ? uint64_t(games / seconds) : games; }
+};
+
+/**
+ * Plays games of random moves to the end, as randomAI does, but without printing
+ * and without seeding the random numbers again for every move. The move lists and
+ * the moves to take back are kept between games, so once they have grown a playout
+ * only allocates for promotions, which create a new piece.
+ * The board is left unchanged.
+ */
+class Playout {
+public:
+    explicit Playout(uint64_t seed);
+
+    // A game that reaches the 50-move rule or maxPlies is a draw
+    PlayoutResult play(ChessBoard & cb, int maxPlies = 1000);
+
+private:
+    Xoshiro256 m_rng;
+    vector<ChessMove> m_moves;
+    vector<UndoInfo> m_undos;
+};
+
+// Play games from the position of cb with the given number of threads, e.g. to measure games per second
+PlayoutStats runPlayouts(ChessBoard & cb, uint64_t games, int threads, uint64_t seed);
+
+#endif //PLAYOUT_H
@@ -0,0 +1,85 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of pondering
+*/
+
+#include "Ponder.h"
+
+#include <chrono>
+
+using namespace std;
+
+Ponderer::~Ponderer() {
+    stop();
+}
+
+bool Ponderer::start(ChessBoard & cb, const SearchLimits & limits) {
+    stop();
+
+    // The expected reply is the move the search stored for the opponent, or its only move
+    vector<ChessMove> moves;
+    cb.generateMoves(cb.whiteToMove(), moves);
+    TTData entry;
+    TranspositionTable & table = searchTable(limits.hash_mb);
+    uint16_t expected = moves.size() == 1 ? packMove(moves[0]) : (table.probe(cb.getHash(), entry) ? entry.move : 0);
+    auto reply = find_if(moves.begin(), moves.end(), [&](const ChessMove & move) { return packMove(move) == expected; });
+    if (expected == 0 || reply == moves.end()) {
+        return false;
+    }
+    m_expected = *reply;
+    m_expected.piece = nullptr;    // belongs to cb
+
+    m_board = make_unique<ChessBoard>(cb);
+    vector<ChessMove> copyMoves;
+    m_board->generateMoves(m_board->whiteToMove(), copyMoves);
+    for (const ChessMove & move : copyMoves) {
+        if (packMove(move) == expected) {
+            m_board->makeMove(move);
+            break;
+        }
+    }
+
+    SearchLimits ponderLimits = limits;
+    ponderLimits.milliseconds = 0;
+    ponderLimits.nodes = 0;
+    ponderLimits.stop = &m_stop;
+    m_stop = false;
+    m_search = make_unique<Search>(*m_board, table);
+    holdSearchTable();      // released once the search has finished
+    m_result = async(launch::async, [this, ponderLimits]() { return m_search->think(ponderLimits); });
+    return true;
+}
+
+bool Ponderer::finish(const ChessMove & move, const SearchLimits & limits, SearchResult & result) {
+    if (!pondering()) {
+        return false;
+    }
+    if (packMove(move) != packMove(m_expected)) {
+        stop();
+        return false;
+    }
+    if (limits.milliseconds > 0 && m_result.wait_for(chrono::milliseconds(limits.milliseconds)) == future_status::timeout) {
+        m_stop = true;
+    }
+    m_result.wait();            // without a time limit the search ends at its depth
+    releaseSearchTable();
+    result = m_result.get();
+    m_search.reset();
+    m_board.reset();
+    return true;
+}
+
+void Ponderer::stop() {
+    if (pondering()) {
+        m_stop = true;
+        m_result.wait();
+        releaseSearchTable();
+        m_result.get();
+    }
+    m_search.reset();
+    m_board.reset();
+}
@@ -0,0 +1,57 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Pondering header file
+*/
+
+#ifndef PONDER_H
+#define PONDER_H
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include "Search.h"
+
+using namespace std;
+
+/**
+ * Searches on the opponent's time.
+ * After the engine has moved, the reply it expects (the opponent's move in the
+ * transposition table) is played on a copy of the board, and the engine's answer to it
+ * is searched in a background thread that shares the table with the normal search.
+ * If the opponent plays that reply, the search carries on and gets the normal time
+ * for the move from then on. Otherwise it is stopped, and only what it stored in the
+ * table is used. Node limits do not apply while pondering.
+ */
+class Ponderer {
+public:
+    Ponderer() = default;
+    Ponderer(const Ponderer & other) = delete;
+    Ponderer & operator=(const Ponderer & other) = delete;
+    ~Ponderer();
+
+    // Start pondering on the position after the engine's move. Returns false if no reply is expected
+    bool start(ChessBoard & cb, const SearchLimits & limits);
+
+    // The opponent has played move. On a ponder hit the search finishes within limits and
+    // its result is returned. Returns false and stops pondering on a miss
+    bool finish(const ChessMove & move, const SearchLimits & limits, SearchResult & result);
+
+    void stop();
+    bool pondering() const { return m_result.valid(); }
+    const ChessMove & expected() const { return m_expected; }
+
+private:
+    unique_ptr<ChessBoard> m_board;
+    unique_ptr<Search> m_search;
+    ChessMove m_expected{-1, -1, -1, -1, nullptr};
+    atomic<bool> m_stop{false};
+    future<SearchResult> m_result;
+};
+
+#endif //PONDER_H
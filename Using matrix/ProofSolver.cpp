@@ -0,0 +1,255 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the proof-number solver
+*/
+
+#include "ProofSolver.h"
+
+#include <algorithm>
+
+using namespace std;
+
+ProofSolver::ProofSolver(ChessBoard & cb) : m_board(cb), m_moves(proofMaxPly), m_child_keys(proofMaxPly) {}
+
+static uint32_t addNumbers(uint32_t a, uint32_t b) {
+    return min(a + b, proofInfinite);
+}
+
+// Entries are grouped 4 to a bucket. Empty entries read as unknown (1, 1)
+void ProofSolver::lookup(uint64_t key, uint32_t & pn, uint32_t & dn) const {
+    size_t bucket = key & m_mask & ~size_t(3);
+    for (size_t i = bucket; i < bucket + 4; i++) {
+        if (m_table[i].key == key) {
+            pn = m_table[i].pn;
+            dn = m_table[i].dn;
+            return;
+        }
+    }
+    pn = 1;
+    dn = 1;
+}
+
+// Replace the same position, or else the unsolved entry with the least work
+void ProofSolver::store(uint64_t key, uint32_t pn, uint32_t dn, uint32_t work) {
+    size_t bucket = key & m_mask & ~size_t(3);
+    Entry * replace = &m_table[bucket];
+    uint64_t replaceValue = UINT64_MAX;
+    for (size_t i = bucket; i < bucket + 4; i++) {
+        Entry & entry = m_table[i];
+        if (entry.key == key) {
+            replace = &entry;
+            break;
+        }
+        bool solved = entry.pn == 0 || entry.dn == 0;
+        uint64_t value = entry.work + (solved ? (uint64_t(1) << 32) : 0);
+        if (value < replaceValue) {
+            replace = &entry;
+            replaceValue = value;
+        }
+    }
+    replace->key = key;
+    replace->pn = pn;
+    replace->dn = dn;
+    replace->work = work;
+}
+
+/**
+ * Multiple iterative deepening of one position. The position is expanded until its
+ * proof number reaches thresholdPn or its disproof number reaches thresholdDn.
+ * At positions where the attacker moves one good move is enough (OR node),
+ * where the defender moves every move must be answered (AND node)
+ */
+void ProofSolver::mid(uint32_t thresholdPn, uint32_t thresholdDn, size_t ply) {
+    m_nodes++;
+    if ((m_nodes & 1023) == 0 && chrono::steady_clock::now() > m_deadline) {
+        m_timeout = true;
+    }
+    if (m_timeout) {
+        return;
+    }
+    const uint64_t key = m_board.getHash();
+    const bool attackerToMove = m_board.whiteToMove() == m_attacker_white;
+
+    if (ply == proofMaxPly) { // Too long to prove, counts as not won for the attacker
+        store(key, proofInfinite, 0, 1);
+        return;
+    }
+    vector<ChessMove> & moves = m_moves[ply];
+    m_board.generateMoves(m_board.whiteToMove(), moves);
+    if (moves.empty()) { // The side to move has won
+        if (attackerToMove) {
+            store(key, 0, proofInfinite, 1);
+        } else {
+            store(key, proofInfinite, 0, 1);
+        }
+        return;
+    }
+
+    vector<uint64_t> & childKeys = m_child_keys[ply];
+    childKeys.resize(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        UndoInfo undo = m_board.makeMove(moves[i]);
+        childKeys[i] = m_board.getHash();
+        m_board.unmakeMove(undo);
+    }
+
+    m_path.push_back(key);
+    const uint64_t startNodes = m_nodes;
+    uint32_t pn = 1;
+    uint32_t dn = 1;
+    while (true) {
+        // Combine the numbers of the children, and find the most proving child and the runner-up
+        size_t best = 0;
+        uint32_t bestNumber = proofInfinite;
+        uint32_t secondNumber = proofInfinite;
+        uint32_t bestPn = 1;
+        uint32_t bestDn = 1;
+        pn = attackerToMove ? proofInfinite : 0;
+        dn = attackerToMove ? 0 : proofInfinite;
+        for (size_t i = 0; i < moves.size(); i++) {
+            uint32_t childPn;
+            uint32_t childDn;
+            if (find(m_path.begin(), m_path.end(), childKeys[i]) != m_path.end()) { // Repetition
+                childPn = proofInfinite;
+                childDn = 0;
+            } else {
+                lookup(childKeys[i], childPn, childDn);
+            }
+
+            uint32_t number = attackerToMove ? childPn : childDn;
+            if (number < bestNumber) {
+                secondNumber = bestNumber;
+                bestNumber = number;
+                best = i;
+                bestPn = childPn;
+                bestDn = childDn;
+            } else if (number < secondNumber) {
+                secondNumber = number;
+            }
+            if (attackerToMove) {
+                pn = min(pn, childPn);
+                dn = addNumbers(dn, childDn);
+            } else {
+                pn = addNumbers(pn, childPn);
+                dn = min(dn, childDn);
+            }
+        }
+        if (pn >= thresholdPn || dn >= thresholdDn || m_timeout) {
+            break;
+        }
+
+        uint32_t childThresholdPn;
+        uint32_t childThresholdDn;
+        if (attackerToMove) {
+            childThresholdPn = min(thresholdPn, secondNumber + 1);
+            childThresholdDn = thresholdDn >= proofInfinite ? proofInfinite : thresholdDn - dn + bestDn;
+        } else {
+            childThresholdPn = thresholdPn >= proofInfinite ? proofInfinite : thresholdPn - pn + bestPn;
+            childThresholdDn = min(thresholdDn, secondNumber + 1);
+        }
+        UndoInfo undo = m_board.makeMove(moves[best]);
+        mid(childThresholdPn, childThresholdDn, ply + 1);
+        m_board.unmakeMove(undo);
+    }
+    m_path.pop_back();
+    store(key, pn, dn, static_cast<uint32_t>(min<uint64_t>(m_nodes - startNodes, UINT32_MAX)));
+}
+
+// Try to prove a win for the given side from the current position
+bool ProofSolver::prove(bool attackerIsWhite) {
+    m_attacker_white = attackerIsWhite;
+    fill(m_table.begin(), m_table.end(), Entry());
+    m_path.clear();
+    mid(proofInfinite, proofInfinite, 0);
+
+    uint32_t pn;
+    uint32_t dn;
+    lookup(m_board.getHash(), pn, dn);
+    return !m_timeout && pn == 0;
+}
+
+/**
+ * Follow the proof from the root. The winner plays a proved move,
+ * the loser the move that took the most work to refute.
+ * The line ends early if the table no longer holds the rest of the proof
+ */
+vector<ChessMove> ProofSolver::proofLine() {
+    vector<ChessMove> line;
+    vector<UndoInfo> undos;
+    vector<ChessMove> moves;
+    while (line.size() < 1000) {
+        bool attackerToMove = m_board.whiteToMove() == m_attacker_white;
+        m_board.generateMoves(m_board.whiteToMove(), moves);
+
+        int best = -1;
+        uint32_t bestWork = 0;
+        for (size_t i = 0; i < moves.size(); i++) {
+            undos.push_back(m_board.makeMove(moves[i]));
+            uint64_t key = m_board.getHash();
+            m_board.unmakeMove(undos.back());
+            undos.pop_back();
+
+            uint32_t pn;
+            uint32_t dn;
+            lookup(key, pn, dn);
+            if (pn != 0) {
+                continue;
+            }
+            size_t bucket = key & m_mask & ~size_t(3);
+            uint32_t work = 0;
+            for (size_t j = bucket; j < bucket + 4; j++) {
+                if (m_table[j].key == key) work = m_table[j].work;
+            }
+            if (best < 0 || (!attackerToMove && work > bestWork)) {
+                best = i;
+                bestWork = work;
+            }
+            if (attackerToMove) {
+                break;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        line.push_back(moves[best]);
+        undos.push_back(m_board.makeMove(moves[best]));
+    }
+    while (!undos.empty()) {
+        m_board.unmakeMove(undos.back());
+        undos.pop_back();
+    }
+    return line;
+}
+
+// Prove a win for the side to move, or else for the opponent, within the limits
+ProofResult ProofSolver::solve(const ProofLimits & limits) {
+    auto start = chrono::steady_clock::now();
+    m_deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(limits.seconds));
+    m_timeout = false;
+    m_nodes = 0;
+
+    size_t nrEntries = 4;
+    while (nrEntries * 2 * sizeof(Entry) <= limits.hash_mb * 1024 * 1024) {
+        nrEntries *= 2;
+    }
+    m_table.assign(nrEntries, Entry());
+    m_mask = nrEntries - 1;
+
+    ProofResult result;
+    bool white = m_board.whiteToMove();
+    if (prove(white)) {
+        result.value = proofWin;
+    } else if (!m_timeout && prove(!white)) {
+        result.value = proofLoss;
+    }
+    if (result.value != proofUnknown) {
+        result.line = proofLine();
+    }
+    result.nodes = m_nodes;
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,85 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Proof-number solver header file
+*/
+
+#ifndef PROOFSOLVER_H
+#define PROOFSOLVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+
+using namespace std;
+
+const uint32_t proofInfinite = 1u << 30;   // proof or disproof number of a solved position
+const size_t proofMaxPly = 1000;            // longest line the solver follows
+
+enum ProofValue {
+    proofUnknown,   // not solved within the limits, or a draw
+    proofWin,       // the side to move wins
+    proofLoss       // the side to move loses
+};
+
+struct ProofLimits {
+    size_t hash_mb = 64;            // memory for the table of proof and disproof numbers
+    double seconds = 10;
+};
+
+struct ProofResult {
+    ProofValue value = proofUnknown;
+    vector<ChessMove> line;         // moves of the winning side and the longest defence found, from the root
+    uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+/**
+ * Depth-first proof-number search (df-pn) that proves positions as forced wins or losses.
+ * The solver first tries to prove a win for the side to move, and if that is disproved,
+ * a win for the opponent. Proof and disproof numbers are kept in a table of fixed size,
+ * so the search runs in bounded memory.
+ *
+ * The 50-move rule is ignored, as usual when solving positions. A position that repeats
+ * on the current line counts as not won for the side being proved, so proofs are always
+ * sound but a disproof may be caused by a repetition.
+ * The board is left unchanged when solve() returns.
+ */
+class ProofSolver {
+public:
+    explicit ProofSolver(ChessBoard & cb);
+
+    ProofResult solve(const ProofLimits & limits);
+
+private:
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t pn = 1;
+        uint32_t dn = 1;
+        uint32_t work = 0;          // nodes spent on the position, decides what is replaced
+    };
+
+    bool prove(bool attackerIsWhite);
+    void mid(uint32_t thresholdPn, uint32_t thresholdDn, size_t ply);
+    void lookup(uint64_t key, uint32_t & pn, uint32_t & dn) const;
+    void store(uint64_t key, uint32_t pn, uint32_t dn, uint32_t work);
+    vector<ChessMove> proofLine();
+
+    ChessBoard & m_board;
+    vector<Entry> m_table;
+    size_t m_mask = 0;
+    bool m_attacker_white = true;
+    vector<vector<ChessMove>> m_moves;      // one move list per ply
+    vector<vector<uint64_t>> m_child_keys;  // hashes of the positions after these moves
+    vector<uint64_t> m_path;                // positions on the current line, to find repetitions
+    uint64_t m_nodes = 0;
+    chrono::steady_clock::time_point m_deadline;
+    bool m_timeout = false;
+};
+
+#endif //PROOFSOLVER_H
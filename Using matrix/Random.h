@@ -0,0 +1,33 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Random number generator header file
+*/
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * xoshiro256** random number generator. Small and fast, so every thread can have its own.
+ * The state is filled from the seed with splitmix64.
+ */
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(uint64_t seed = 0);
+
+    uint64_t next();
+    // Uniform number in [0, n), by multiplying instead of dividing
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+
+private:
+    uint64_t m_state[4];
+};
+
+#endif //RANDOM_H
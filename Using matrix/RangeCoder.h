@@ -0,0 +1,92 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Range coder header file
+
+  A carry-less 32-bit range coder (Subbotin). Symbols are coded with their
+  cumulative frequency, frequency and total frequency, where the total must
+  stay below 2^16.
+*/
+
+#ifndef RANGECODER_H
+#define RANGECODER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+const uint32_t rangeCoderTop = 1u << 24;
+const uint32_t rangeCoderBottom = 1u << 16;
+
+class RangeEncoder {
+public:
+    explicit RangeEncoder(vector<uint8_t> & out) : m_out(out) {}
+
+    void encode(uint32_t cumFreq, uint32_t freq, uint32_t totFreq) {
+        m_range /= totFreq;
+        m_low += cumFreq * m_range;
+        m_range *= freq;
+        while ((m_low ^ (m_low + m_range)) < rangeCoderTop ||
+               (m_range < rangeCoderBottom && ((m_range = -m_low & (rangeCoderBottom - 1)), true))) {
+            m_out.push_back(static_cast<uint8_t>(m_low >> 24));
+            m_low <<= 8;
+            m_range <<= 8;
+        }
+    }
+
+    // Write the remaining state. Must be called once after the last symbol
+    void finish() {
+        for (int i = 0; i < 4; i++) {
+            m_out.push_back(static_cast<uint8_t>(m_low >> 24));
+            m_low <<= 8;
+        }
+    }
+
+private:
+    vector<uint8_t> & m_out;
+    uint32_t m_low = 0;
+    uint32_t m_range = 0xFFFFFFFFu;
+};
+
+class RangeDecoder {
+public:
+    RangeDecoder(const uint8_t * data, size_t size) : m_data(data), m_end(data + size) {
+        for (int i = 0; i < 4; i++) {
+            m_code = (m_code << 8) | nextByte();
+        }
+    }
+
+    // Cumulative frequency of the next symbol. Must be followed by decode()
+    uint32_t getFreq(uint32_t totFreq) {
+        m_range /= totFreq;
+        uint32_t value = (m_code - m_low) / m_range;
+        return value < totFreq ? value : totFreq - 1;
+    }
+
+    void decode(uint32_t cumFreq, uint32_t freq) {
+        m_low += cumFreq * m_range;
+        m_range *= freq;
+        while ((m_low ^ (m_low + m_range)) < rangeCoderTop ||
+               (m_range < rangeCoderBottom && ((m_range = -m_low & (rangeCoderBottom - 1)), true))) {
+            m_code = (m_code << 8) | nextByte();
+            m_low <<= 8;
+            m_range <<= 8;
+        }
+    }
+
+private:
+    uint8_t nextByte() { return m_data != m_end ? *m_data++ : 0; }
+
+    const uint8_t * m_data;
+    const uint8_t * m_end;
+    uint32_t m_low = 0;
+    uint32_t m_range = 0xFFFFFFFFu;
+    uint32_t m_code = 0;
+};
+
+#endif //RANGECODER_H
@@ -44,14 +44,14 @@ int Rook::validMove(int to_x, int to_y) {
 
     // Check for blocking pieces along the path
     for (int i = 1; i < steps; i++) {       // Check each square along the path except the destination square
-        shared_ptr<ChessPiece> pathSquare = m_board->getChessBoard()(m_x + directionX * i, m_y + directionY * i);
+        shared_ptr<ChessPiece> & pathSquare = m_board->getChessBoard()(m_x + directionX * i, m_y + directionY * i);
         if (pathSquare != nullptr) {
             return 0; // Blocked by another piece
         }
     }
 
     // Check the final destination square
-    shared_ptr<ChessPiece> newSquare = m_board->getChessBoard()(to_x, to_y);
+    shared_ptr<ChessPiece> & newSquare = m_board->getChessBoard()(to_x, to_y);
     if (newSquare == nullptr) { // Non capturing. Empty square
         return 1; 
     } else if (newSquare->pieceIsWhite() != m_is_white) { // Capturing opponent's piece
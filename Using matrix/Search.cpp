@@ -0,0 +1,501 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the search
+*/
+
+#include "Search.h"
+#include "Tablebase.h"
+#include "Evaluation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+Search::Search(ChessBoard & cb, TranspositionTable & tt) : m_board(cb), m_tt(tt), m_moves(maxPly + 1), m_scores(maxPly + 1), m_ordering(maxPly) {}
+
+// Win scores depend on the distance to the root. The table stores them as distance to the position instead
+static int scoreToTT(int score, int ply) {
+    if (score >= winScore - maxWinDistance) return score + ply;
+    if (score <= -winScore + maxWinDistance) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if (score >= winScore - maxWinDistance) return score - ply;
+    if (score <= -winScore + maxWinDistance) return score + ply;
+    return score;
+}
+
+// Static evaluation from the point of view of the side to move. The moves of the position are already
+// generated wherever it is evaluated, so mobility comes for free and the rest is kept up to date by the board
+int Search::evaluate(int mobility) {
+    if (m_nnue != nullptr) { // kept well away from the win scores
+        return clamp(m_nnue->evaluate(m_accumulator, m_board.whiteToMove()), -winScore / 2, winScore / 2);
+    }
+    return evaluatePosition(m_board, mobility);
+}
+
+SearchStats & SearchStats::operator+=(const SearchStats & other) {
+    nodes += other.nodes;
+    quiescence_nodes += other.quiescence_nodes;
+    tt_probes += other.tt_probes;
+    tt_hits += other.tt_hits;
+    cutoffs += other.cutoffs;
+    first_move_cutoffs += other.first_move_cutoffs;
+    if (iterations.empty()) {
+        iterations = other.iterations;
+    }
+    return *this;
+}
+
+double SearchStats::branchingFactor() const {
+    size_t n = iterations.size();
+    if (n < 2 || iterations[n - 2].nodes == 0) {
+        return 0;
+    }
+    return double(iterations[n - 1].nodes - iterations[n - 2].nodes) / max<uint64_t>(iterations[n - 2].nodes - (n > 2 ? iterations[n - 3].nodes : 0), 1);
+}
+
+// "info depth 6 score -120 nodes 81234 nps 1520000 time 53 ebf 3.41 qnodes 40211 tthit 0.372 fmc 0.914 threads 1"
+string SearchStats::infoLine(int threads, double seconds) const {
+    ostringstream line;
+    line << fixed << setprecision(3);
+    line << "info depth " << (iterations.empty() ? 0 : iterations.back().depth)
+         << " score " << (iterations.empty() ? 0 : iterations.back().score)
+         << " nodes " << nodes << " nps " << (seconds > 0 ? uint64_t(nodes / seconds) : nodes)
+         << " time " << int(seconds * 1000) << " ebf " << branchingFactor() << " qnodes " << quiescence_nodes
+         << " tthit " << ttHitRate() << " fmc " << firstMoveCutoffRate() << " threads " << threads;
+    return line.str();
+}
+
+string SearchStats::json(int threads, double seconds) const {
+    ostringstream out;
+    out << fixed << setprecision(3);
+    out << "{\"nodes\":" << nodes << ",\"quiescence_nodes\":" << quiescence_nodes << ",\"nps\":" << (seconds > 0 ? uint64_t(nodes / seconds) : nodes)
+        << ",\"milliseconds\":" << int(seconds * 1000) << ",\"threads\":" << threads
+        << ",\"tt_probes\":" << tt_probes << ",\"tt_hits\":" << tt_hits << ",\"cutoffs\":" << cutoffs
+        << ",\"first_move_cutoffs\":" << first_move_cutoffs << ",\"ebf\":" << branchingFactor() << ",\"iterations\":[";
+    for (size_t i = 0; i < iterations.size(); i++) {
+        const IterationStats & iteration = iterations[i];
+        out << (i > 0 ? "," : "") << "{\"depth\":" << iteration.depth << ",\"score\":" << iteration.score
+            << ",\"nodes\":" << iteration.nodes << ",\"milliseconds\":" << iteration.milliseconds << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+// Check the limits of the search. Called every few hundred nodes, so a stop comes well within a millisecond
+void Search::pollLimits() {
+    if (m_stop == nullptr) {
+        return;
+    }
+    uint64_t totalNodes = m_shared_nodes->fetch_add(m_nodes - m_reported_nodes, memory_order_relaxed) + m_nodes - m_reported_nodes;
+    m_reported_nodes = m_nodes;
+    if ((m_node_limit > 0 && totalNodes >= m_node_limit) || (m_has_deadline && chrono::steady_clock::now() >= m_deadline) ||
+        (m_external_stop != nullptr && m_external_stop->load(memory_order_relaxed))) {
+        m_stop->store(true, memory_order_relaxed);
+    }
+}
+
+// Exact score of a position in the tablebase. Wins that take longer score lower
+bool Search::probeTablebase(int ply, int & score) {
+    TablebaseProbe probe;
+    if (m_tablebase == nullptr || !m_tablebase->probe(m_board, probe)) {
+        return false;
+    }
+    if (probe.result == tbDraw) {
+        score = 0;
+    } else {
+        score = winScore - ply - min(probe.distance, maxWinDistance - maxPly);  // longer distances are rounded down to stay a win score
+        if (probe.result == tbLoss) score = -score;
+    }
+    return true;
+}
+
+// Write the counters after an iteration of the main thread. The node count includes what the helpers
+// have reported so far, the other counters are the main thread's until think() adds them up
+void Search::reportIteration(const SearchLimits & limits) {
+    if (limits.info == nullptr) {
+        return;
+    }
+    SearchStats stats = m_stats;
+    stats.nodes = m_nodes + (m_shared_nodes != nullptr ? m_shared_nodes->load(memory_order_relaxed) - m_reported_nodes : 0);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - m_start).count();
+    int threads = limits.threads > 1 ? limits.threads : 1;
+    *limits.info << (limits.info_json ? stats.json(threads, seconds) : stats.infoLine(threads, seconds)) << endl;
+}
+
+// Negamax with alpha-beta pruning. Returns the score from the point of view of the side to move
+int Search::negamax(int depth, int alpha, int beta, int ply) {
+    if (stopped()) { // The result is thrown away, so any score will do
+        return 0;
+    }
+    if ((++m_nodes & 255) == 0) {
+        pollLimits();
+    }
+    if (m_board.getHalfmoveClock() >= 100) { // Draw by the 50-move rule
+        return 0;
+    }
+    int tablebaseScore;
+    if (probeTablebase(ply, tablebaseScore)) {
+        return tablebaseScore;
+    }
+    const int originalAlpha = alpha;
+    const uint64_t key = m_board.getHash();
+
+    // A result from the table that is deep enough may end the search of this position
+    TTData entry;
+    uint16_t ttMove = 0;
+    m_stats.tt_probes++;
+    if (m_tt.probe(key, entry)) {
+        m_stats.tt_hits++;
+        ttMove = entry.move;
+        if (entry.depth >= depth) {
+            int score = scoreFromTT(entry.score, ply);
+            if (entry.bound == boundExact ||
+                (entry.bound == boundLower && score >= beta) ||
+                (entry.bound == boundUpper && score <= alpha)) {
+                return score;
+            }
+        }
+    }
+
+    if (depth == 0) {
+        m_quiescenceLeft = quiescenceNodes;
+        return quiescence(alpha, beta, ply);
+    }
+
+    vector<ChessMove> & moves = m_moves[ply];
+    m_board.generateMoves(m_board.whiteToMove(), moves);
+    if (moves.empty()) { // No moves left means the side to move has won. Sooner wins score higher
+        return winScore - ply;
+    }
+    if (ply == maxPly) {
+        return evaluate(moves.size());
+    }
+    vector<int> & scores = m_scores[ply];
+    m_ordering.scoreMoves(m_board, moves, scores, ttMove, ply);
+    bool captures = m_board.getChessBoard()(moves[0].to_x, moves[0].to_y) != nullptr;
+
+    int bestScore = -infiniteScore;
+    uint16_t bestMove = 0;
+    for (size_t i = 0; i < moves.size(); i++) {
+        MoveOrdering::pickNext(moves, scores, i);
+        const ChessMove & move = moves[i];
+        UndoInfo undo = m_board.makeMove(move);
+        int score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+        m_board.unmakeMove(undo);
+        if (stopped()) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = packMove(move);
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) { // The opponent will avoid this position
+                    m_stats.cutoffs++;
+                    if (i == 0) m_stats.first_move_cutoffs++;
+                    if (!captures) {
+                        m_ordering.updateQuiet(m_board, moves, i, depth, ply);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    TTData result;
+    result.move = bestMove;
+    result.score = scoreToTT(bestScore, ply);
+    result.depth = depth;
+    result.bound = bestScore >= beta ? boundLower : (bestScore > originalAlpha ? boundExact : boundUpper);
+    m_tt.store(key, result);
+    return bestScore;
+}
+
+/**
+ * Search of the captures after the horizon.
+ * Capturing is compulsory, so unlike in normal chess the side to move can not stand pat
+ * while it has a capture. The search goes on until a position without captures is reached.
+ * Sequences that can not bring the score back above alpha are cut off (delta pruning),
+ * and a node cap keeps long capture chains from taking over the search
+ */
+int Search::quiescence(int alpha, int beta, int ply) {
+    if (stopped()) {
+        return 0;
+    }
+    if ((++m_nodes & 255) == 0) {
+        pollLimits();
+    }
+    m_stats.quiescence_nodes++;
+    int tablebaseScore;
+    if (probeTablebase(ply, tablebaseScore)) {
+        return tablebaseScore;
+    }
+
+    vector<ChessMove> & moves = m_moves[ply];
+    m_board.generateMoves(m_board.whiteToMove(), moves);
+    if (moves.empty()) {
+        return winScore - ply;
+    }
+    int staticScore = evaluate(moves.size());
+    bool captures = m_board.getChessBoard()(moves[0].to_x, moves[0].to_y) != nullptr;
+    if (!captures || ply == maxPly || --m_quiescenceLeft <= 0) { // Quiet position or out of nodes
+        return staticScore;
+    }
+    if (staticScore + deltaMargin <= alpha) {
+        return staticScore + deltaMargin;
+    }
+
+    vector<int> & scores = m_scores[ply];
+    m_ordering.scoreMoves(m_board, moves, scores, 0, ply);
+
+    int bestScore = -infiniteScore;
+    for (size_t i = 0; i < moves.size(); i++) {
+        MoveOrdering::pickNext(moves, scores, i);
+        UndoInfo undo = m_board.makeMove(moves[i]);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        m_board.unmakeMove(undo);
+        if (stopped()) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+    return bestScore;
+}
+
+// The moves of the lines first, best first, then the other moves in the order they had
+static void orderRootMoves(vector<ChessMove> & moves, vector<int> & scores, size_t nrLines) {
+    vector<size_t> order(moves.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[a] > scores[b]; });
+    sort(order.begin() + nrLines, order.end());
+
+    vector<ChessMove> orderedMoves;
+    vector<int> orderedScores;
+    for (size_t index : order) {
+        orderedMoves.push_back(moves[index]);
+        orderedScores.push_back(scores[index]);
+    }
+    moves = move(orderedMoves);
+    scores = move(orderedScores);
+}
+
+// The line starting with the root move first, continued with the moves stored in the table.
+// It ends where the table has no move or a position comes back. Only the first move has its piece set
+vector<ChessMove> Search::principalVariation(const ChessMove & first, int maxLength) {
+    vector<ChessMove> line{first};
+    vector<UndoInfo> undos{m_board.makeMove(first)};
+    vector<uint64_t> seen{m_board.getHash()};
+    vector<ChessMove> moves;
+    TTData entry;
+    while (int(line.size()) < maxLength && m_tt.probe(m_board.getHash(), entry) && entry.move != 0) {
+        m_board.generateMoves(m_board.whiteToMove(), moves);
+        auto next = find_if(moves.begin(), moves.end(), [&](const ChessMove & m) { return packMove(m) == entry.move; });
+        if (next == moves.end()) {
+            break;
+        }
+        undos.push_back(m_board.makeMove(*next));
+        if (find(seen.begin(), seen.end(), m_board.getHash()) != seen.end()) {
+            m_board.unmakeMove(undos.back());
+            undos.pop_back();
+            break;
+        }
+        seen.push_back(m_board.getHash());
+        line.push_back(*next);
+        line.back().piece = nullptr;
+    }
+    while (!undos.empty()) {
+        m_board.unmakeMove(undos.back());
+        undos.pop_back();
+    }
+    return line;
+}
+
+// Iterative deepening in one thread. The best move of each iteration is searched first in the next one
+SearchResult Search::iterate(const SearchLimits & limits, int threadId) {
+    SearchResult result;
+    m_nodes = 0;
+    m_reported_nodes = 0;
+    m_stats = SearchStats();
+    m_tablebase = limits.tablebase;
+    m_ordering.newSearch();
+
+    vector<ChessMove> rootMoves;
+    m_board.generateMoves(m_board.whiteToMove(), rootMoves);
+    if (rootMoves.empty()) {
+        return result;
+    }
+    result.has_move = true;
+    result.best_move = rootMoves[0];
+
+    // The board updates the accumulator as the search makes and takes back moves
+    m_nnue = limits.nnue;
+    if (m_nnue != nullptr) {
+        m_accumulator.weights = &m_nnue->weights();
+        m_board.setAccumulator(&m_accumulator);
+    }
+
+    // Helpers start with a different move order and odd helpers search one ply deeper
+    if (threadId > 0) {
+        rotate(rootMoves.begin(), rootMoves.begin() + threadId % rootMoves.size(), rootMoves.end());
+    }
+    int extraDepth = threadId % 2;
+
+    // A move only gets an exact score if it beats alpha. With several lines alpha is the score
+    // of the last line found so far, so all lines get exact scores from the same search
+    size_t nrLines = min<size_t>(max(limits.multi_pv, 1), rootMoves.size());
+    vector<int> rootScores(rootMoves.size());
+    vector<int> lineScores;     // the best scores so far, highest first
+
+    for (int depth = 1 + extraDepth; depth <= limits.depth + extraDepth && depth < maxPly; depth++) {
+        int alpha = -infiniteScore;
+        lineScores.clear();
+        for (size_t i = 0; i < rootMoves.size(); i++) {
+            UndoInfo undo = m_board.makeMove(rootMoves[i]);
+            int score = -negamax(depth - 1, -infiniteScore, -alpha, 1);
+            m_board.unmakeMove(undo);
+            if (stopped()) {
+                break;
+            }
+
+            rootScores[i] = score;
+            if (score > alpha) {
+                lineScores.insert(upper_bound(lineScores.begin(), lineScores.end(), score, greater<int>()), score);
+                if (lineScores.size() > nrLines) lineScores.pop_back();
+                alpha = lineScores.size() == nrLines ? lineScores.back() : -infiniteScore;
+            }
+        }
+        if (stopped()) { // Unfinished iteration
+            break;
+        }
+        orderRootMoves(rootMoves, rootScores, nrLines);
+
+        result.best_move = rootMoves[0];
+        result.score = rootScores[0];
+        result.depth = depth;
+        alpha = rootScores[0];
+        if (threadId == 0) {
+            result.lines.clear();
+            for (size_t line = 0; line < nrLines; line++) {
+                result.lines.push_back({rootScores[line], principalVariation(rootMoves[line], depth)});
+            }
+        }
+        if (threadId == 0) {
+            IterationStats iteration;
+            iteration.depth = depth;
+            iteration.score = alpha;
+            iteration.nodes = m_nodes;
+            iteration.milliseconds = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - m_start).count();
+            m_stats.iterations.push_back(iteration);
+            reportIteration(limits);
+        }
+        if (alpha >= winScore - maxWinDistance || alpha <= -winScore + maxWinDistance) { // Forced result found
+            break;
+        }
+        if (threadId == 0 && m_has_deadline && chrono::steady_clock::now() >= m_soft_deadline) {
+            break;
+        }
+    }
+    if (m_nnue != nullptr) {
+        m_board.setAccumulator(nullptr);
+    }
+    result.nodes = m_nodes;
+    m_stats.nodes = m_nodes;
+    result.stats = m_stats;
+    return result;
+}
+
+// Search with the main thread and limits.threads - 1 helper threads
+SearchResult Search::think(const SearchLimits & limits) {
+    auto start = chrono::steady_clock::now();
+    m_tt.newSearch();
+
+    // All threads share the stop flag and the node count
+    atomic<bool> stop{false};
+    atomic<uint64_t> sharedNodes{0};
+    auto shareLimits = [&](Search & search) {
+        search.m_stop = &stop;
+        search.m_shared_nodes = &sharedNodes;
+        search.m_node_limit = limits.nodes;
+        search.m_external_stop = limits.stop;
+        search.m_start = start;
+        search.m_has_deadline = limits.milliseconds > 0;
+        search.m_deadline = start + chrono::milliseconds(limits.milliseconds);
+        search.m_soft_deadline = start + chrono::milliseconds(limits.milliseconds / 2);
+    };
+    shareLimits(*this);
+
+    // Every helper gets its own board and search
+    vector<unique_ptr<ChessBoard>> boards;
+    vector<unique_ptr<Search>> helpers;
+    vector<SearchResult> helperResults(limits.threads > 1 ? limits.threads - 1 : 0);
+    vector<thread> threads;
+    for (int i = 1; i < limits.threads; i++) {
+        boards.push_back(make_unique<ChessBoard>(m_board));
+        helpers.push_back(make_unique<Search>(*boards.back(), m_tt));
+        shareLimits(*helpers.back());
+    }
+    for (int i = 1; i < limits.threads; i++) {
+        threads.emplace_back([&, i]() { helperResults[i - 1] = helpers[i - 1]->iterate(limits, i); });
+    }
+
+    SearchResult result = iterate(limits, 0);
+
+    stop = true;
+    for (thread & helper : threads) {
+        helper.join();
+    }
+    for (const SearchResult & helperResult : helperResults) {
+        result.nodes += helperResult.nodes;
+        result.stats += helperResult.stats;
+    }
+    m_stop = nullptr;
+    result.threads = limits.threads > 1 ? limits.threads : 1;
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static mutex searchTableMutex;
+static int searchTableHolders = 0;
+
+TranspositionTable & searchTable(int hash_mb) {
+    static TranspositionTable table(hash_mb);
+    lock_guard<mutex> lock(searchTableMutex);
+    if (table.sizeMB() != size_t(hash_mb) && searchTableHolders == 0) {
+        table.resize(hash_mb);
+    }
+    return table;
+}
+
+void holdSearchTable() {
+    lock_guard<mutex> lock(searchTableMutex);
+    searchTableHolders++;
+}
+
+void releaseSearchTable() {
+    lock_guard<mutex> lock(searchTableMutex);
+    searchTableHolders--;
+}
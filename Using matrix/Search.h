@@ -0,0 +1,172 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Search header file
+*/
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ChessBoard.h"
+#include "ChessMove.h"
+#include "MoveOrdering.h"
+#include "Nnue.h"
+#include "TranspositionTable.h"
+
+using namespace std;
+
+class Tablebase;
+
+const int winScore = 30000;             // score of a won position at the root. Must fit in a TT entry
+const int infiniteScore = winScore + 1;
+const int maxPly = 128;
+const int maxWinDistance = 1024;        // plies from the root to a forced result that win scores can hold, tablebase distances included
+const int quiescenceNodes = 1024;       // most nodes one quiescence search may visit from the horizon
+const int deltaMargin = 300;            // largest swing a capture sequence is assumed to make
+
+// How much the search may do for one move. It stops at whichever limit comes first
+struct SearchLimits {
+    int depth = 4;
+    uint64_t nodes = 0;             // all threads together, 0 for no limit
+    int milliseconds = 0;           // hard deadline for the move, 0 for no limit
+    int hash_mb = 16;               // size of the transposition table
+    int threads = 1;                // helper threads share the transposition table (lazy SMP)
+    const Tablebase * tablebase = nullptr;  // exact results for positions with few pieces
+    const Nnue * nnue = nullptr;            // evaluate with this network instead of the handcrafted terms
+    const atomic<bool> * stop = nullptr;    // set by another thread to stop the search, as when pondering ends
+    int multi_pv = 1;                       // number of best moves to find scores and lines for
+    ostream * info = nullptr;               // a line for every iteration of the main thread
+    bool info_json = false;                 // as a JSON object instead of an info line
+};
+
+// One finished iteration of the main thread
+struct IterationStats {
+    int depth = 0;
+    int score = 0;
+    uint64_t nodes = 0;             // of the main thread, since the start of the search
+    int milliseconds = 0;
+};
+
+/**
+ * Counters of the search. Each thread counts in its own copy without atomics,
+ * and think() adds the copies up once the threads are done.
+ */
+struct SearchStats {
+    uint64_t nodes = 0;             // including quiescence nodes
+    uint64_t quiescence_nodes = 0;
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    uint64_t cutoffs = 0;           // beta cutoffs in the main search
+    uint64_t first_move_cutoffs = 0;    // of which by the first move searched
+    vector<IterationStats> iterations;  // main thread only
+
+    SearchStats & operator+=(const SearchStats & other);
+
+    double ttHitRate() const { return tt_probes > 0 ? double(tt_hits) / tt_probes : 0; }
+    double firstMoveCutoffRate() const { return cutoffs > 0 ? double(first_move_cutoffs) / cutoffs : 0; }
+    // Growth in nodes from one iteration to the next, over the last two iterations
+    double branchingFactor() const;
+
+    string infoLine(int threads, double seconds) const;
+    string json(int threads, double seconds) const;
+};
+
+// A best move with its score and the expected moves after it
+struct SearchLine {
+    int score = 0;
+    vector<ChessMove> moves;        // the first is the move itself
+};
+
+struct SearchResult {
+    ChessMove best_move{-1, -1, -1, -1, nullptr};
+    bool has_move = false;          // false if the side to move has no moves, i.e. has won
+    int score = 0;                  // from the point of view of the side to move
+    int depth = 0;                  // last completed iteration
+    uint64_t nodes = 0;             // all threads together
+    double seconds = 0;
+    int threads = 1;
+    SearchStats stats;              // all threads together
+    vector<SearchLine> lines;       // SearchLimits.multi_pv best moves, best first
+
+    uint64_t nodesPerSecond() const { return seconds > 0 ? uint64_t(nodes / seconds) : nodes; }
+};
+
+/**
+ * Iterative deepening negamax search with alpha-beta pruning and a transposition table.
+ * At the horizon a quiescence search plays out the forced captures, so positions
+ * are only evaluated when the side to move has no capture.
+ * The search makes and takes back moves on the given board, which is
+ * left unchanged when think() returns.
+ *
+ * The best move of the last completed iteration is always ready, so the search can be
+ * stopped at any time. Every few hundred nodes each thread checks the clock and the node
+ * count, and the first thread to see a limit passed stops them all. No new iteration is
+ * started after half the time, since it would most likely not finish.
+ *
+ * With more than one thread, helper threads run the same iterative deepening
+ * on their own copies of the board (lazy SMP). They share only the transposition
+ * table, and odd helpers search one ply deeper so the threads fill it with
+ * different results. The helpers stop when the main thread is done.
+ *
+ * For analysis the search can find several best moves at once (multi-PV). The root
+ * moves are searched against the score of the last of the best moves instead of the
+ * best one, so every line gets an exact score from one search and one table. The moves
+ * of each line after the first are followed from the table.
+ */
+class Search {
+public:
+    Search(ChessBoard & cb, TranspositionTable & tt);
+
+    SearchResult think(const SearchLimits & limits);
+
+private:
+    SearchResult iterate(const SearchLimits & limits, int threadId);
+    int negamax(int depth, int alpha, int beta, int ply);
+    int quiescence(int alpha, int beta, int ply);
+    int evaluate(int mobility);
+    bool probeTablebase(int ply, int & score);
+    bool stopped() const { return m_stop != nullptr && m_stop->load(memory_order_relaxed); }
+    void pollLimits();
+    void reportIteration(const SearchLimits & limits);
+    vector<ChessMove> principalVariation(const ChessMove & first, int maxLength);
+
+    ChessBoard & m_board;
+    TranspositionTable & m_tt;
+    atomic<bool> * m_stop = nullptr;        // shared by all threads of a search
+    atomic<uint64_t> * m_shared_nodes = nullptr;
+    uint64_t m_reported_nodes = 0;          // part of m_nodes added to m_shared_nodes
+    uint64_t m_node_limit = 0;
+    const atomic<bool> * m_external_stop = nullptr;
+    chrono::steady_clock::time_point m_start;
+    SearchStats m_stats;
+    bool m_has_deadline = false;
+    chrono::steady_clock::time_point m_deadline;
+    chrono::steady_clock::time_point m_soft_deadline;   // no new iterations after this
+    const Tablebase * m_tablebase = nullptr;
+    const Nnue * m_nnue = nullptr;
+    NnueAccumulator m_accumulator;          // kept up to date by the board while m_nnue is set
+    uint64_t m_nodes = 0;
+    int m_quiescenceLeft = 0;               // nodes left for the current quiescence search
+    vector<vector<ChessMove>> m_moves;  // one move list per ply, reused between nodes
+    vector<vector<int>> m_scores;       // ordering scores of the moves
+    MoveOrdering m_ordering;
+};
+
+// The table of the search AIs. It is kept between moves, so earlier searches help the next one.
+// It is resized to hash_mb, except while a background search holds it
+TranspositionTable & searchTable(int hash_mb);
+
+// Background searches on the table, such as pondering, hold it while they run so it is not resized under them
+void holdSearchTable();
+void releaseSearchTable();
+
+#endif //SEARCH_H
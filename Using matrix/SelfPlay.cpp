@@ -0,0 +1,139 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of self-play
+*/
+
+#include "SelfPlay.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "Search.h"
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+
+using namespace std;
+
+static const char * startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1";
+
+// Attempts at each number of random moves before trying one move fewer
+static const int randomMoveAttempts = 16;
+
+// Plays the random moves at the start of a game. Returns false if the game ended during them
+static bool playRandomMoves(ChessBoard & board, int plies, Xoshiro256 & random, vector<ChessMove> & moves) {
+    for (int ply = 0; ply < plies; ply++) {
+        board.generateMoves(board.whiteToMove(), moves);
+        if (moves.empty()) {
+            return false;
+        }
+        board.makeMove(moves[random.below(moves.size())]);
+    }
+    board.generateMoves(board.whiteToMove(), moves);
+    return !moves.empty();
+}
+
+// Plays one game and returns its result. The samples get the result once it is known
+static int playGame(const SelfPlayOptions & options, uint64_t game, ChessBoard & board, Search & search, vector<TrainingSample> & samples) {
+    const string & opening = options.openings.empty() ? startPosition : options.openings[game % options.openings.size()];
+    Xoshiro256 random(options.seed ^ (game * 0x9E3779B97F4A7C15ULL));
+    vector<ChessMove> moves;
+
+    // Every random line may end the game early near the end of a game, so fewer random moves are
+    // played then. Without random moves the opening itself must have moves, which runSelfPlay checks
+    int plies = options.random_plies;
+    board.setFen(opening);
+    for (int attempt = 1; !playRandomMoves(board, plies, random, moves); attempt++) {
+        if (attempt % randomMoveAttempts == 0) plies--;
+        board.setFen(opening);
+    }
+
+    SearchLimits limits;
+    limits.depth = options.depth;
+    limits.nodes = options.nodes;
+    limits.tablebase = options.tablebase;
+    limits.nnue = options.nnue;
+
+    samples.clear();
+    int result = 0;
+    for (int ply = 0; ply < options.max_plies; ply++) {
+        if (board.getHalfmoveClock() >= 100) {
+            break;
+        }
+        TablebaseProbe probe;
+        if (options.tablebase != nullptr && options.tablebase->probe(board, probe)) {
+            if (probe.result != tbDraw) result = (probe.result == tbWin) == board.whiteToMove() ? 1 : -1;
+            break;
+        }
+        board.generateMoves(board.whiteToMove(), moves);
+        if (moves.empty()) { // The side to move has no pieces or no moves and wins
+            result = board.whiteToMove() ? 1 : -1;
+            break;
+        }
+
+        SearchResult searchResult = search.think(limits);
+        if (board.getChessBoard()(moves[0].to_x, moves[0].to_y) == nullptr) {
+            TrainingSample sample{};
+            sample.position = packBoard(board);
+            sample.score = static_cast<int16_t>(clamp(searchResult.score, -32767, 32767));
+            sample.ply = static_cast<uint16_t>(plies + ply);
+            samples.push_back(sample);
+        }
+        board.makeMove(searchResult.best_move);
+    }
+    for (TrainingSample & sample : samples) {
+        sample.result = static_cast<int8_t>(result);
+    }
+    return result;
+}
+
+SelfPlayStats runSelfPlay(const SelfPlayOptions & options, ShardWriter & writer, ostream & log) {
+    // An opening that is already over would give games without positions
+    ChessBoard board;
+    vector<ChessMove> moves;
+    for (const string & opening : options.openings) {
+        board.setFen(opening);
+        board.generateMoves(board.whiteToMove(), moves);
+        if (moves.empty()) {
+            throw invalid_argument("The side to move has no moves in opening " + opening + "!");
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+    atomic<uint64_t> nextGame{0};
+    atomic<uint64_t> whiteWins{0}, blackWins{0}, draws{0};
+    mutex logMutex;
+    runThreads(options.threads, [&](int) {
+        ChessBoard board;
+        TranspositionTable tt(options.hash_mb);
+        Search search(board, tt);
+        vector<TrainingSample> samples;
+        for (uint64_t game = nextGame++; game < options.games; game = nextGame++) {
+            int result = playGame(options, game, board, search, samples);
+            writer.write(samples);
+            (result > 0 ? whiteWins : result < 0 ? blackWins : draws)++;
+
+            uint64_t finished = whiteWins + blackWins + draws;
+            if (finished % 100 == 0) {
+                double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                lock_guard<mutex> lock(logMutex);
+                log << finished << " games, " << writer.samples() << " positions, " << finished / seconds << " games/s" << endl;
+            }
+        }
+    }, [&]() { nextGame = options.games; });
+
+    SelfPlayStats stats;
+    stats.white_wins = whiteWins;
+    stats.black_wins = blackWins;
+    stats.draws = draws;
+    stats.games = stats.white_wins + stats.black_wins + stats.draws;
+    stats.samples = writer.samples();
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,58 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Self-play header file
+*/
+
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "TrainingData.h"
+
+using namespace std;
+
+class Tablebase;
+class Nnue;
+
+struct SelfPlayOptions {
+    uint64_t games = 1000;
+    int threads = 1;
+    int depth = 6;                  // of the search for every move
+    uint64_t nodes = 0;             // per move, 0 for no limit
+    int hash_mb = 16;               // per thread
+    int random_plies = 8;           // random moves at the start of each game
+    int max_plies = 400;            // games still going after this many plies are draws
+    uint64_t seed = 1;              // game n is played with a seed made from this and n
+    vector<string> openings;        // FEN positions to start from in turn, the normal start position if empty
+    const Tablebase * tablebase = nullptr;  // ends games as soon as their result is known
+    const Nnue * nnue = nullptr;
+};
+
+struct SelfPlayStats {
+    uint64_t games = 0;
+    uint64_t samples = 0;
+    uint64_t white_wins = 0;
+    uint64_t black_wins = 0;
+    uint64_t draws = 0;
+    double seconds = 0;
+
+    double gamesPerSecond() const { return seconds > 0 ? games / seconds : games; }
+};
+
+/**
+ * Plays games of the search against itself on several threads, each with its own board and
+ * transposition table, and writes the quiet positions with their search score and the result
+ * of the game to writer. Positions with a capture are left out, since the evaluation is
+ * only used where the side to move has none. Games start with a few random moves so they differ.
+ * Progress is written to log every 100 games.
+ */
+SelfPlayStats runSelfPlay(const SelfPlayOptions & options, ShardWriter & writer, ostream & log);
+
+#endif //SELFPLAY_H
@@ -0,0 +1,384 @@
+/*
+* Sparse matrix class
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Compressed sparse row (CSR) storage with the same element access and
+  iteration API as Matrix. Only non-default elements are stored, so memory
+  and iteration cost scale with the number of non-empty cells.
+*/
+
+#ifndef SPARSEMATRIX_H
+#define SPARSEMATRIX_H
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <algorithm>
+#include <vector>
+#include "Matrix.h"
+
+template <typename T>
+class SparseMatrix {
+    static_assert(std::is_move_constructible<T>::value,"T must be move-constructible");
+    static_assert(std::is_move_assignable<T>::value,"T must be move-assignable");
+public:
+    // constructors
+    SparseMatrix();
+    explicit SparseMatrix(size_t dim);
+    SparseMatrix(size_t rows, size_t cols);
+    explicit SparseMatrix(const Matrix<T> & dense);
+    SparseMatrix(size_t rows, size_t cols, std::vector<size_t> && rowStart, std::vector<size_t> && colIndex, std::vector<T> && values);
+
+    // accessors
+    size_t rows() const;
+    size_t cols() const;
+    size_t nonZeros() const;
+
+    T & operator()(size_t row, size_t col);         // inserts a default element if the cell is empty
+    const T & operator()(size_t row, size_t col) const;
+    bool contains(size_t row, size_t col) const;
+
+    // operators
+    Matrix<T> operator*(const Matrix<T> & dense) const;
+
+    // methods
+    void reset();
+    void erase(size_t row, size_t col);
+    void prune();                                   // remove stored elements equal to T()
+    Matrix<T> toDense() const;
+
+    // Column of a stored element, given its position in the iteration order
+    size_t columnOf(size_t index) const;
+    // Range [rowBegin(row), rowEnd(row)) of stored elements in a row
+    size_t rowBegin(size_t row) const;
+    size_t rowEnd(size_t row) const;
+
+    // iterators (over stored elements only, row by row)
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    size_t find(size_t row, size_t col) const;     // index into m_values or nonZeros() if missing
+
+    size_t m_rows;
+    size_t m_cols;
+    std::vector<size_t> m_row_start;                // size m_rows + 1
+    std::vector<size_t> m_col_index;
+    std::vector<T> m_values;
+};
+
+// input/output operators
+template<typename T>
+std::istream & operator>>(std::istream & is, SparseMatrix<T> & m);
+
+template<typename T>
+std::ostream & operator<<(std::ostream & os, const SparseMatrix<T> & m);
+
+//
+// Implementations
+//
+
+// CONSTRUCTORS
+
+// Empty matrix
+template<typename T>
+SparseMatrix<T>::SparseMatrix() : m_rows(0), m_cols(0), m_row_start(1, 0) {}
+
+// Square matrix with no stored elements
+template<typename T>
+SparseMatrix<T>::SparseMatrix(size_t dim) : m_rows(dim), m_cols(dim), m_row_start(dim + 1, 0) {}
+
+// Defined row and column size with no stored elements
+template<typename T>
+SparseMatrix<T>::SparseMatrix(size_t rows, size_t cols) : m_rows(rows), m_cols(cols), m_row_start(rows + 1, 0) {}
+
+// Conversion from a dense matrix. Only non-default elements are kept
+template<typename T>
+SparseMatrix<T>::SparseMatrix(const Matrix<T> & dense) : m_rows(dense.rows()), m_cols(dense.cols()), m_row_start(dense.rows() + 1, 0) {
+    const T empty = T();
+    for (size_t i = 0; i < m_rows; i++) {
+        for (size_t j = 0; j < m_cols; j++) {
+            if (!(dense(i, j) == empty)) {
+                m_col_index.push_back(j);
+                m_values.push_back(dense(i, j));
+            }
+        }
+        m_row_start[i + 1] = m_values.size();
+    }
+}
+
+// Construct directly from CSR arrays. Columns must be sorted within each row
+template<typename T>
+SparseMatrix<T>::SparseMatrix(size_t rows, size_t cols, std::vector<size_t> && rowStart, std::vector<size_t> && colIndex, std::vector<T> && values)
+    : m_rows(rows), m_cols(cols), m_row_start(std::move(rowStart)), m_col_index(std::move(colIndex)), m_values(std::move(values)) {
+    if (m_row_start.size() != rows + 1 || m_col_index.size() != m_values.size() || m_row_start.back() != m_values.size()) {
+        throw std::invalid_argument("Invalid CSR arrays!");
+    }
+}
+
+// ACCESSORS
+
+template<typename T>
+size_t SparseMatrix<T>::rows() const {
+    return m_rows;
+}
+
+template<typename T>
+size_t SparseMatrix<T>::cols() const {
+    return m_cols;
+}
+
+// Number of stored elements
+template<typename T>
+size_t SparseMatrix<T>::nonZeros() const {
+    return m_values.size();
+}
+
+// Binary search for a column inside the row's segment
+template<typename T>
+size_t SparseMatrix<T>::find(size_t row, size_t col) const {
+    auto first = m_col_index.begin() + m_row_start[row];
+    auto last = m_col_index.begin() + m_row_start[row + 1];
+    auto it = std::lower_bound(first, last, col);
+    if (it != last && *it == col) {
+        return it - m_col_index.begin();
+    }
+    return m_values.size();
+}
+
+// Access/modify an element. An empty cell gets a default element inserted
+template<typename T>
+T & SparseMatrix<T>::operator()(size_t row, size_t col) {
+    if (row >= m_rows || col >= m_cols) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    size_t index = find(row, col);
+    if (index != m_values.size()) {
+        return m_values[index];
+    }
+
+    // Insert in column order inside the row and shift the following rows
+    auto first = m_col_index.begin() + m_row_start[row];
+    auto last = m_col_index.begin() + m_row_start[row + 1];
+    index = std::lower_bound(first, last, col) - m_col_index.begin();
+    m_col_index.insert(m_col_index.begin() + index, col);
+    m_values.insert(m_values.begin() + index, T());
+    for (size_t i = row + 1; i <= m_rows; i++) {
+        m_row_start[i]++;
+    }
+    return m_values[index];
+}
+
+// Access an element - read only version. Empty cells read as T()
+template<typename T>
+const T & SparseMatrix<T>::operator()(size_t row, size_t col) const {
+    static const T empty = T();
+    if (row >= m_rows || col >= m_cols) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    size_t index = find(row, col);
+    return index != m_values.size() ? m_values[index] : empty;
+}
+
+// Check if a cell has a stored element
+template<typename T>
+bool SparseMatrix<T>::contains(size_t row, size_t col) const {
+    if (row >= m_rows || col >= m_cols) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    return find(row, col) != m_values.size();
+}
+
+// OPERATORS
+
+// Sparse x dense multiplication. Only stored elements contribute to the result
+template<typename T>
+Matrix<T> SparseMatrix<T>::operator*(const Matrix<T> & dense) const {
+    if (m_cols != dense.rows()) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    Matrix<T> resultMatrix(m_rows, dense.cols());
+    for (size_t i = 0; i < m_rows; i++) {
+        for (size_t k = m_row_start[i]; k < m_row_start[i + 1]; k++) {
+            const T & value = m_values[k];
+            size_t row = m_col_index[k];
+            for (size_t j = 0; j < dense.cols(); j++) {     // scale row of dense matrix and accumulate
+                resultMatrix(i, j) += value * dense(row, j);
+            }
+        }
+    }
+    return resultMatrix;
+}
+
+// FUNCTIONS
+
+// Reset to an empty matrix
+template<typename T>
+void SparseMatrix<T>::reset() {
+    m_rows = 0;
+    m_cols = 0;
+    m_row_start.assign(1, 0);
+    m_col_index.clear();
+    m_values.clear();
+}
+
+// Remove a stored element. Nothing happens if the cell is empty
+template<typename T>
+void SparseMatrix<T>::erase(size_t row, size_t col) {
+    if (row >= m_rows || col >= m_cols) {
+        throw std::out_of_range("Wrong dimensions!");
+    }
+    size_t index = find(row, col);
+    if (index == m_values.size()) {
+        return;
+    }
+    m_col_index.erase(m_col_index.begin() + index);
+    m_values.erase(m_values.begin() + index);
+    for (size_t i = row + 1; i <= m_rows; i++) {
+        m_row_start[i]--;
+    }
+}
+
+// Remove all stored elements that have been set back to the default value
+template<typename T>
+void SparseMatrix<T>::prune() {
+    const T empty = T();
+    size_t kept = 0;
+    size_t rowFirst = 0;
+    for (size_t i = 0; i < m_rows; i++) {
+        size_t rowLast = m_row_start[i + 1];
+        for (size_t k = rowFirst; k < rowLast; k++) {
+            if (!(m_values[k] == empty)) {
+                m_col_index[kept] = m_col_index[k];
+                m_values[kept] = std::move(m_values[k]);
+                kept++;
+            }
+        }
+        rowFirst = rowLast;
+        m_row_start[i + 1] = kept;
+    }
+    m_col_index.resize(kept);
+    m_values.resize(kept);
+}
+
+// Conversion to a dense matrix
+template<typename T>
+Matrix<T> SparseMatrix<T>::toDense() const {
+    Matrix<T> dense(m_rows, m_cols);
+    for (size_t i = 0; i < m_rows; i++) {
+        for (size_t k = m_row_start[i]; k < m_row_start[i + 1]; k++) {
+            dense(i, m_col_index[k]) = m_values[k];
+        }
+    }
+    return dense;
+}
+
+template<typename T>
+size_t SparseMatrix<T>::columnOf(size_t index) const {
+    return m_col_index.at(index);
+}
+
+template<typename T>
+size_t SparseMatrix<T>::rowBegin(size_t row) const {
+    return m_row_start.at(row);
+}
+
+template<typename T>
+size_t SparseMatrix<T>::rowEnd(size_t row) const {
+    return m_row_start.at(row + 1);
+}
+
+// ITERATORS
+
+template<typename T>
+typename SparseMatrix<T>::iterator SparseMatrix<T>::begin() {
+    return m_values.data();
+}
+
+template<typename T>
+typename SparseMatrix<T>::iterator SparseMatrix<T>::end() {
+    return m_values.data() + m_values.size();
+}
+
+template<typename T>
+typename SparseMatrix<T>::const_iterator SparseMatrix<T>::begin() const {
+    return m_values.data();
+}
+
+template<typename T>
+typename SparseMatrix<T>::const_iterator SparseMatrix<T>::end() const {
+    return m_values.data() + m_values.size();
+}
+
+// INPUT / OUTPUT
+
+// Input operator. Reads the same format as Matrix but only keeps non-default elements
+template<typename T>
+std::istream & operator>>(std::istream & is, SparseMatrix<T> & m) {
+    std::vector<size_t> rowStart(1, 0);
+    std::vector<size_t> colIndex;
+    std::vector<T> values;
+    std::string line;
+    size_t columns = 0;
+    const T empty = T();
+
+    while (std::getline(is, line)) {
+        std::replace(line.begin(), line.end(), '[', ' ');
+        std::replace(line.begin(), line.end(), ']', ' ');
+
+        std::istringstream rowIS(line);
+        T columnElement;
+        size_t col = 0;
+        while (rowIS >> columnElement) {
+            if (!(columnElement == empty)) {
+                colIndex.push_back(col);
+                values.push_back(std::move(columnElement));
+            }
+            col++;
+        }
+        if (rowStart.size() == 1) {         // first row decides the number of columns
+            columns = col;
+        } else if (col != columns) {
+            throw std::out_of_range("Wrong dimensions!");     // a row is longer or shorter than the first one
+        }
+        rowStart.push_back(values.size());
+    }
+
+    size_t rows = rowStart.size() - 1;
+    m = SparseMatrix<T>(rows, columns, std::move(rowStart), std::move(colIndex), std::move(values));
+    return is;
+}
+
+// Output operator. Same layout as Matrix, empty cells are written as T()
+template<typename T>
+std::ostream & operator<<(std::ostream & os, const SparseMatrix<T> & m) {
+    const T empty = T();
+    for (size_t i = 0; i < m.rows(); i++) {
+        os << (i == 0 ? "[ " : "  ");
+        size_t k = m.rowBegin(i);
+        for (size_t j = 0; j < m.cols(); j++) {
+            if (k < m.rowEnd(i) && m.columnOf(k) == j) {
+                os << *(m.begin() + k);
+                k++;
+            } else {
+                os << empty;
+            }
+            if (j < m.cols()-1) {
+                os << " ";
+            }
+        }
+        os << (i == m.rows() - 1 ? " ]" : "\n");
+    }
+    return os;
+}
+
+#endif //SPARSEMATRIX_H
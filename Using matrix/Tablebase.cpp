@@ -0,0 +1,370 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the endgame tablebases
+*/
+
+#include "Tablebase.h"
+#include "ChessBoard.h"
+#include "ChessPiece.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+static const char pieceOrder[] = "kqrbnp";
+static const char fileMagic[8] = {'L', 'C', 'T', 'B', '0', '0', '1', '\0'};
+
+// Header of a table file. The palette and the packed codes follow
+struct TablebaseHeader {
+    char magic[8];
+    char name[16];
+    uint64_t entries;
+    uint32_t bits;              // bits per code
+    uint32_t paletteSize;
+};
+
+static int pieceRank(char piece) {
+    return strchr(pieceOrder, tolower(piece)) - pieceOrder;
+}
+
+string TablebaseMaterial::name() const {
+    string result;
+    for (char piece : white) result += toupper(piece);
+    result += 'v';
+    for (char piece : black) result += toupper(piece);
+    return result;
+}
+
+bool TablebaseMaterial::hasPawns() const {
+    return white.find('p') != string::npos || black.find('p') != string::npos;
+}
+
+// Squares the leading piece is moved to by symmetry
+static size_t leadSquares(bool hasPawns) {
+    return hasPawns ? 24 : 10;
+}
+
+size_t TablebaseMaterial::size() const {
+    size_t result = leadSquares(hasPawns()) * 2;
+    for (int i = 1; i < pieces(); i++) {
+        result *= 64;
+    }
+    return result;
+}
+
+// The stronger side has more pieces, or else the better pieces. Tables are stored with white as the stronger side
+static bool strongerOrEqual(const string & a, const string & b) {
+    if (a.size() != b.size()) {
+        return a.size() > b.size();
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) {
+            return pieceRank(a[i]) < pieceRank(b[i]);
+        }
+    }
+    return true;
+}
+
+// Symmetries of the board. Bit 0 mirrors the rows, bit 1 the columns and bit 2 swaps rows and columns
+static void transform(int symmetry, int & x, int & y) {
+    if (symmetry & 1) x = 7 - x;
+    if (symmetry & 2) y = 7 - y;
+    if (symmetry & 4) swap(x, y);
+}
+
+// Index of the square of the leading piece, or -1 if it is not one of the lead squares
+static int leadIndex(bool hasPawns, int x, int y) {
+    if (hasPawns) {
+        return (x >= 1 && x <= 6 && y <= 3) ? (x - 1) * 4 + y : -1;
+    }
+    return (y <= x && x <= 3) ? x * (x + 1) / 2 + y : -1;
+}
+
+static void leadSquare(bool hasPawns, int index, int & x, int & y) {
+    if (hasPawns) {
+        x = index / 4 + 1;
+        y = index % 4;
+        return;
+    }
+    for (x = 0; index > x; x++) {
+        index -= x + 1;
+    }
+    y = index;
+}
+
+// Pieces of the material in index order: white in "kqrbnp" order, then black. Returns the position of the leading piece
+static size_t orderedPieces(const TablebaseMaterial & material, string & pieces) {
+    pieces.clear();
+    for (char piece : material.white) pieces += toupper(piece);
+    pieces += material.black;
+    size_t lead = material.hasPawns() ? pieces.find_first_of("Pp") : 0;
+    return lead;
+}
+
+void tablebaseIndex(vector<TablebasePiece> pieces, bool whiteToMove, TablebaseMaterial & material, size_t & index) {
+    material.white.clear();
+    material.black.clear();
+    for (const TablebasePiece & piece : pieces) {
+        (isupper(piece.piece) ? material.white : material.black) += tolower(piece.piece);
+    }
+    auto byRank = [](char a, char b) { return pieceRank(a) < pieceRank(b); };
+    sort(material.white.begin(), material.white.end(), byRank);
+    sort(material.black.begin(), material.black.end(), byRank);
+
+    // Swap the colours so that white is the stronger side
+    if (!strongerOrEqual(material.white, material.black)) {
+        swap(material.white, material.black);
+        for (TablebasePiece & piece : pieces) {
+            piece.piece = isupper(piece.piece) ? tolower(piece.piece) : toupper(piece.piece);
+            piece.x = 7 - piece.x;
+        }
+        whiteToMove = !whiteToMove;
+    }
+    sort(pieces.begin(), pieces.end(), [](const TablebasePiece & a, const TablebasePiece & b) {
+        if (isupper(a.piece) != isupper(b.piece)) return isupper(a.piece) != 0;
+        return pieceRank(a.piece) < pieceRank(b.piece);
+    });
+
+    string order;
+    size_t lead = orderedPieces(material, order);
+    bool hasPawns = material.hasPawns();
+    int nrSymmetries = hasPawns ? 2 : 8;
+
+    // Try the symmetries, and each piece of the leading kind as the leading piece, until one is on a lead square
+    for (int s = 0; s < nrSymmetries; s++) {
+        int symmetry = hasPawns ? s * 2 : s;     // pawns only allow mirroring the columns
+        for (size_t i = lead; i < pieces.size() && pieces[i].piece == order[lead]; i++) {
+            int x = pieces[i].x;
+            int y = pieces[i].y;
+            transform(symmetry, x, y);
+            int leadSquareIndex = leadIndex(hasPawns, x, y);
+            if (leadSquareIndex < 0) {
+                continue;
+            }
+            index = leadSquareIndex;
+            for (size_t j = 0; j < pieces.size(); j++) {
+                if (j == i) continue;
+                int px = pieces[j].x;
+                int py = pieces[j].y;
+                transform(symmetry, px, py);
+                index = index * 64 + px * 8 + py;
+            }
+            index = index * 2 + (whiteToMove ? 0 : 1);
+            return;
+        }
+    }
+    throw logic_error("No symmetry puts the leading piece on a lead square!");
+}
+
+bool tablebasePosition(const TablebaseMaterial & material, size_t index, FenPosition & position) {
+    string order;
+    size_t lead = orderedPieces(material, order);
+    bool hasPawns = material.hasPawns();
+
+    memset(position.squares, '.', sizeof(position.squares));
+    position.white_to_move = (index & 1) == 0;
+    position.halfmove_clock = 0;
+    position.fullmove_number = 1;
+    position.operations = nullptr;
+    position.operations_length = 0;
+    index >>= 1;
+
+    // The other pieces were added last, so they come out in reverse order
+    for (size_t j = order.size(); j-- > 0; ) {
+        if (j == lead) continue;
+        int square = index % 64;
+        index /= 64;
+        char & target = position.squares[square / 8][square % 8];
+        if (target != '.' || (tolower(order[j]) == 'p' && (square < 8 || square >= 56))) {
+            return false;
+        }
+        target = order[j];
+    }
+    int x;
+    int y;
+    leadSquare(hasPawns, static_cast<int>(index), x, y);
+    if (position.squares[x][y] != '.') {
+        return false;
+    }
+    position.squares[x][y] = order[lead];
+    return true;
+}
+
+void writeTablebaseFile(const string & path, const TablebaseMaterial & material, const vector<uint16_t> & values) {
+    vector<uint16_t> palette(values);
+    sort(palette.begin(), palette.end());
+    palette.erase(unique(palette.begin(), palette.end()), palette.end());
+    uint32_t bits = 0;
+    while ((size_t(1) << bits) < palette.size()) {
+        bits++;
+    }
+
+    TablebaseHeader header{};
+    memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    string name = material.name();
+    strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+    header.entries = values.size();
+    header.bits = bits;
+    header.paletteSize = palette.size();
+
+    // Codes are packed into 64-bit words, plus one spare word so a probe may always read two
+    vector<uint64_t> words((values.size() * bits + 63) / 64 + 1, 0);
+    for (size_t i = 0; i < values.size() && bits > 0; i++) {
+        uint64_t code = lower_bound(palette.begin(), palette.end(), values[i]) - palette.begin();
+        size_t bit = i * bits;
+        words[bit / 64] |= code << (bit % 64);
+        if (bit % 64 + bits > 64) {
+            words[bit / 64 + 1] |= code >> (64 - bit % 64);
+        }
+    }
+
+    ofstream file(path, ios::binary);
+    if (!file) {
+        throw runtime_error("Could not create " + path + ".");
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(palette.data()), palette.size() * sizeof(uint16_t));
+    static const char padding[8] = {};
+    file.write(padding, (8 - palette.size() * sizeof(uint16_t) % 8) % 8);  // codes start on a word boundary
+    file.write(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(uint64_t));
+    if (!file) {
+        throw runtime_error("Could not write " + path + ".");
+    }
+}
+
+TablebaseFile::TablebaseFile(const string & path) : m_file(path, accessRandom) {
+    TablebaseHeader header;
+    if (m_file.size() < sizeof(header)) {
+        throw invalid_argument(path + " is not a tablebase file!");
+    }
+    memcpy(&header, m_file.data(), sizeof(header));
+    size_t paletteBytes = (header.paletteSize * sizeof(uint16_t) + 7) / 8 * 8;
+    size_t codeBytes = ((header.entries * header.bits + 63) / 64 + 1) * sizeof(uint64_t);
+    if (memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || header.bits > 16 || header.paletteSize == 0 ||
+        m_file.size() < sizeof(header) + paletteBytes + codeBytes) {
+        throw invalid_argument(path + " is not a tablebase file!");
+    }
+    m_palette = reinterpret_cast<const uint16_t *>(m_file.data() + sizeof(header));
+    m_codes = m_file.data() + sizeof(header) + paletteBytes;
+    m_entries = header.entries;
+    m_bits = header.bits;
+}
+
+// Read the code of an entry from the two words it may span
+uint16_t TablebaseFile::value(size_t index) const {
+    if (m_bits == 0) {
+        return m_palette[0];
+    }
+    size_t bit = index * m_bits;
+    uint64_t words[2];
+    memcpy(words, m_codes + bit / 64 * sizeof(uint64_t), sizeof(words));
+    uint64_t code = words[0] >> (bit % 64);
+    if (bit % 64 + m_bits > 64) {
+        code |= words[1] << (64 - bit % 64);
+    }
+    return m_palette[code & ((uint64_t(1) << m_bits) - 1)];
+}
+
+Tablebase::Tablebase(const string & directory, int maxPieces) {
+    for (const TablebaseMaterial & material : tablebaseMaterials(maxPieces)) {
+        if (ifstream(directory + "/" + material.name() + ".lctb")) {
+            load(directory, material);
+        }
+    }
+}
+
+void Tablebase::load(const string & directory, const TablebaseMaterial & material) {
+    string name = material.name();
+    m_tables.erase(name);
+    m_tables.emplace(name, TablebaseFile(directory + "/" + name + ".lctb"));
+    m_max_pieces = max(m_max_pieces, material.pieces());
+}
+
+bool Tablebase::probe(const vector<TablebasePiece> & pieces, bool whiteToMove, TablebaseProbe & probe) const {
+    bool hasWhite = false;
+    bool hasBlack = false;
+    for (const TablebasePiece & piece : pieces) {
+        (isupper(piece.piece) ? hasWhite : hasBlack) = true;
+    }
+    if (!hasWhite || !hasBlack) { // A side without pieces has won
+        probe.result = (hasWhite != whiteToMove) ? tbWin : tbLoss;
+        probe.distance = 0;
+        return true;
+    }
+    if (static_cast<int>(pieces.size()) > m_max_pieces) {
+        return false;
+    }
+
+    TablebaseMaterial material;
+    size_t index;
+    tablebaseIndex(pieces, whiteToMove, material, index);
+    auto table = m_tables.find(material.name());
+    if (table == m_tables.end()) {
+        return false;
+    }
+    probe = decodeTablebaseValue(table->second.value(index));
+    return true;
+}
+
+bool Tablebase::probe(ChessBoard & cb, TablebaseProbe & probe) const {
+    int nrPieces = cb.getWhitePieces().size() + cb.getBlackPieces().size();
+    if (nrPieces > m_max_pieces && !cb.getWhitePieces().empty() && !cb.getBlackPieces().empty()) {
+        return false;
+    }
+    vector<TablebasePiece> pieces;
+    pieces.reserve(nrPieces);
+    for (ChessPiece * piece : cb.getWhitePieces()) {
+        pieces.push_back({piece->getLatin1Representation(), piece->getX(), piece->getY()});
+    }
+    for (ChessPiece * piece : cb.getBlackPieces()) {
+        pieces.push_back({piece->getLatin1Representation(), piece->getX(), piece->getY()});
+    }
+    return this->probe(pieces, cb.whiteToMove(), probe);
+}
+
+// All ways to choose count pieces in "kqrbnp" order
+static void pieceSets(int count, size_t first, string & current, vector<string> & sets) {
+    if (count == 0) {
+        sets.push_back(current);
+        return;
+    }
+    for (size_t i = first; i < 6; i++) {
+        current += pieceOrder[i];
+        pieceSets(count - 1, i, current, sets);
+        current.pop_back();
+    }
+}
+
+// Captures lead to fewer pieces and promotions to fewer pawns, so tables are ordered by pieces and then pawns
+vector<TablebaseMaterial> tablebaseMaterials(int maxPieces) {
+    vector<TablebaseMaterial> materials;
+    for (int pieces = 2; pieces <= maxPieces; pieces++) {
+        vector<TablebaseMaterial> current;
+        for (int white = pieces - 1; white >= (pieces + 1) / 2; white--) {
+            vector<string> whiteSets;
+            vector<string> blackSets;
+            string buffer;
+            pieceSets(white, 0, buffer, whiteSets);
+            pieceSets(pieces - white, 0, buffer, blackSets);
+            for (const string & w : whiteSets) {
+                for (const string & b : blackSets) {
+                    if (strongerOrEqual(w, b)) {
+                        current.push_back({w, b});
+                    }
+                }
+            }
+        }
+        auto pawns = [](const TablebaseMaterial & m) { return count(m.white.begin(), m.white.end(), 'p') + count(m.black.begin(), m.black.end(), 'p'); };
+        stable_sort(current.begin(), current.end(), [&](const TablebaseMaterial & a, const TablebaseMaterial & b) { return pawns(a) < pawns(b); });
+        materials.insert(materials.end(), current.begin(), current.end());
+    }
+    return materials;
+}
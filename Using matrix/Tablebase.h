@@ -0,0 +1,130 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Endgame tablebase header file
+*/
+
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Fen.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+class ChessBoard;
+
+// Most pieces the generator supports. It keeps every move of a table in memory, about 290 MB
+// for the largest 4-piece tables and some 64 times as much with 5 pieces
+const int maxTablebasePieces = 4;
+
+// Result for the side to move
+enum TablebaseResult : uint8_t {
+    tbDraw = 0,
+    tbWin = 1,
+    tbLoss = 2
+};
+
+struct TablebaseProbe {
+    TablebaseResult result = tbDraw;
+    int distance = 0;               // plies to the end of the game with best play
+};
+
+// A piece and its square. Upper case for white as in FEN
+struct TablebasePiece {
+    char piece;
+    int x;
+    int y;
+};
+
+// The pieces of both sides, lower case in "kqrbnp" order. For example white "kn" and black "k"
+struct TablebaseMaterial {
+    string white;
+    string black;
+
+    string name() const;            // "KNvK"
+    int pieces() const { return white.size() + black.size(); }
+    bool hasPawns() const;
+    size_t size() const;            // number of entries in the table
+};
+
+// Entries are 16 bits: the result in bits 0-1 and the distance above them. 0 is a draw
+inline uint16_t encodeTablebaseValue(TablebaseResult result, int distance) {
+    return static_cast<uint16_t>(result | (distance << 2));
+}
+
+inline TablebaseProbe decodeTablebaseValue(uint16_t value) {
+    TablebaseProbe probe;
+    probe.result = static_cast<TablebaseResult>(value & 3);
+    probe.distance = value >> 2;
+    return probe;
+}
+
+/**
+ * Index of a position in the table of its material.
+ * Tables only exist for one colour of each material, so a position with the colours
+ * the other way round is mirrored first. Symmetry puts the leading piece (the first
+ * pawn, or else the first piece) on one of 10 squares of the a8-a5-d5 triangle without pawns,
+ * or on the a-d files with pawns. The other pieces and the side to move follow.
+ * Returns the material of the table in material.
+ */
+void tablebaseIndex(vector<TablebasePiece> pieces, bool whiteToMove, TablebaseMaterial & material, size_t & index);
+
+// Position of an index. Returns false for indices that do not describe a legal placement of the pieces
+bool tablebasePosition(const TablebaseMaterial & material, size_t index, FenPosition & position);
+
+// Write a table. Entries are stored as codes into a palette of the distinct values, packed with as few bits as possible
+void writeTablebaseFile(const string & path, const TablebaseMaterial & material, const vector<uint16_t> & values);
+
+/**
+ * One memory-mapped table file. A probe reads a single packed code.
+ */
+class TablebaseFile {
+public:
+    explicit TablebaseFile(const string & path);
+
+    uint16_t value(size_t index) const;
+    size_t size() const { return m_entries; }
+
+private:
+    MappedFile m_file;
+    const uint16_t * m_palette = nullptr;
+    const char * m_codes = nullptr;
+    size_t m_entries = 0;
+    unsigned m_bits = 0;
+};
+
+/**
+ * The tables found in a directory, probed in constant time during search and adjudication.
+ */
+class Tablebase {
+public:
+    Tablebase() = default;
+    // Loads every table up to maxPieces pieces that exists in directory
+    Tablebase(const string & directory, int maxPieces);
+
+    void load(const string & directory, const TablebaseMaterial & material);
+    bool contains(const TablebaseMaterial & material) const { return m_tables.count(material.name()) > 0; }
+    int maxPieces() const { return m_max_pieces; }
+    size_t size() const { return m_tables.size(); }
+
+    // Returns false if there is no table for the position
+    bool probe(ChessBoard & cb, TablebaseProbe & probe) const;
+    bool probe(const vector<TablebasePiece> & pieces, bool whiteToMove, TablebaseProbe & probe) const;
+
+private:
+    unordered_map<string, TablebaseFile> m_tables;
+    int m_max_pieces = 0;
+};
+
+// Every material with up to maxPieces pieces and pieces on both sides, in the order they must be generated
+vector<TablebaseMaterial> tablebaseMaterials(int maxPieces);
+
+#endif //TABLEBASE_H
@@ -0,0 +1,213 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the tablebase generator
+*/
+
+#include "TablebaseGenerator.h"
+#include "ChessBoard.h"
+#include "ChessPiece.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+const uint16_t unresolved = 0;
+const uint32_t invalidPosition = UINT32_MAX;   // move counter of indices that are not a position
+
+const size_t chunk = 4096;          // positions a thread takes from the shared range at a time
+
+// A result that is known at some distance and must be passed to a position of the table
+struct Event {
+    uint32_t position;
+    TablebaseResult result;     // for the side to move after the move
+};
+
+// Everything one thread finds while expanding the positions
+struct Expansion {
+    vector<pair<uint32_t, uint32_t>> edges;     // (position after the move, position before it)
+    vector<vector<Event>> events;               // moves into other tables, by distance
+    vector<uint32_t> terminal;                  // positions where the side to move has no moves
+};
+
+static void addEvent(vector<vector<Event>> & events, int distance, Event event) {
+    if (distance >= static_cast<int>(events.size())) {
+        events.resize(distance + 1);
+    }
+    events[distance].push_back(event);
+}
+
+// Solve one material. The smaller tables and those with fewer pawns must already be in the tablebase
+static vector<uint16_t> solveMaterial(const TablebaseMaterial & material, int threads, const Tablebase & tablebase) {
+    const size_t size = material.size();
+    const string name = material.name();
+    vector<atomic<uint16_t>> values(size);
+    vector<atomic<uint32_t>> counters(size);     // moves that have not been shown to reach a won position
+    vector<Expansion> expansions(threads);
+
+    // 1. Expand every position
+    parallelFor(size, threads, chunk, [&](size_t begin, size_t end, int threadId) {
+        Expansion & expansion = expansions[threadId];
+        ChessBoard board;
+        FenPosition position;
+        vector<ChessMove> moves;
+        vector<TablebasePiece> pieces;
+        for (size_t index = begin; index < end; index++) {
+            values[index].store(unresolved, memory_order_relaxed);
+            if (!tablebasePosition(material, index, position)) {
+                counters[index].store(invalidPosition, memory_order_relaxed);
+                continue;
+            }
+            board.setPosition(position);
+            board.generateMoves(position.white_to_move, moves);
+            counters[index].store(moves.size(), memory_order_relaxed);
+            if (moves.empty()) {
+                expansion.terminal.push_back(index);
+                continue;
+            }
+            for (const ChessMove & move : moves) {
+                UndoInfo undo = board.makeMove(move);
+                pieces.clear();
+                for (ChessPiece * piece : board.getWhitePieces()) pieces.push_back({piece->getLatin1Representation(), piece->getX(), piece->getY()});
+                for (ChessPiece * piece : board.getBlackPieces()) pieces.push_back({piece->getLatin1Representation(), piece->getX(), piece->getY()});
+
+                TablebaseMaterial next;
+                size_t nextIndex = 0;
+                TablebaseProbe probe;
+                bool sameMaterial = !board.getWhitePieces().empty() && !board.getBlackPieces().empty();
+                if (sameMaterial) {
+                    tablebaseIndex(pieces, board.whiteToMove(), next, nextIndex);
+                    sameMaterial = next.name() == name;
+                }
+                if (sameMaterial) {
+                    expansion.edges.emplace_back(nextIndex, index);
+                } else if (tablebase.probe(pieces, board.whiteToMove(), probe)) {
+                    if (probe.result != tbDraw) {
+                        addEvent(expansion.events, probe.distance, {static_cast<uint32_t>(index), probe.result});
+                    }
+                } else {
+                    throw runtime_error("Tablebase " + next.name() + " is needed for " + name + ".");
+                }
+                board.unmakeMove(undo);
+            }
+        }
+    });
+
+    // 2. Predecessors of each position, in compressed rows
+    vector<uint32_t> rowStart(size + 1, 0);
+    for (const Expansion & expansion : expansions) {
+        for (const auto & edge : expansion.edges) rowStart[edge.first + 1]++;
+    }
+    for (size_t i = 0; i < size; i++) rowStart[i + 1] += rowStart[i];
+    vector<uint32_t> predecessors(rowStart[size]);
+    {
+        vector<uint32_t> fill(rowStart.begin(), rowStart.end() - 1);
+        for (Expansion & expansion : expansions) {
+            for (const auto & edge : expansion.edges) predecessors[fill[edge.first]++] = edge.second;
+            vector<pair<uint32_t, uint32_t>>().swap(expansion.edges);
+        }
+    }
+    vector<vector<Event>> events;
+    for (Expansion & expansion : expansions) {
+        for (size_t distance = 0; distance < expansion.events.size(); distance++) {
+            for (const Event & event : expansion.events[distance]) addEvent(events, distance, event);
+        }
+    }
+
+    // 3. Pass results back one distance at a time. Terminal positions are won by the side to move
+    vector<uint32_t> frontier;
+    for (const Expansion & expansion : expansions) {
+        for (uint32_t index : expansion.terminal) {
+            values[index].store(encodeTablebaseValue(tbWin, 0), memory_order_relaxed);
+            frontier.push_back(index);
+        }
+    }
+
+    vector<vector<uint32_t>> found(threads);
+    // A move to a position with the given result was found for position at this distance
+    auto pass = [&](uint32_t position, TablebaseResult result, int distance, vector<uint32_t> & next) {
+        if (values[position].load(memory_order_relaxed) != unresolved) {
+            return;
+        }
+        uint16_t expected = unresolved;
+        if (result == tbLoss) {
+            if (values[position].compare_exchange_strong(expected, encodeTablebaseValue(tbWin, distance + 1))) {
+                next.push_back(position);
+            }
+        } else if (counters[position].fetch_sub(1) == 1) {
+            if (values[position].compare_exchange_strong(expected, encodeTablebaseValue(tbLoss, distance + 1))) {
+                next.push_back(position);
+            }
+        }
+    };
+
+    for (int distance = 0; !frontier.empty() || distance < static_cast<int>(events.size()); distance++) {
+        if (distance + 1 >= (1 << 14)) {
+            throw runtime_error("Distance too long for tablebase " + name + ".");
+        }
+        vector<Event> noEvents;
+        const vector<Event> & external = distance < static_cast<int>(events.size()) ? events[distance] : noEvents;
+
+        parallelFor(frontier.size() + external.size(), threads, chunk, [&](size_t begin, size_t end, int threadId) {
+            for (size_t i = begin; i < end; i++) {
+                if (i < frontier.size()) {
+                    uint32_t position = frontier[i];
+                    TablebaseResult result = decodeTablebaseValue(values[position].load(memory_order_relaxed)).result;
+                    for (uint32_t k = rowStart[position]; k < rowStart[position + 1]; k++) {
+                        pass(predecessors[k], result, distance, found[threadId]);
+                    }
+                } else {
+                    const Event & event = external[i - frontier.size()];
+                    pass(event.position, event.result, distance, found[threadId]);
+                }
+            }
+        });
+
+        frontier.clear();
+        for (vector<uint32_t> & list : found) {
+            frontier.insert(frontier.end(), list.begin(), list.end());
+            list.clear();
+        }
+    }
+
+    vector<uint16_t> result(size);
+    for (size_t i = 0; i < size; i++) {
+        result[i] = values[i].load(memory_order_relaxed);
+    }
+    return result;
+}
+
+void generateTablebases(const string & directory, int maxPieces, int threads, Tablebase & tablebase, ostream & log) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (maxPieces > maxTablebasePieces) {
+        throw invalid_argument("Tablebases go up to " + to_string(maxTablebasePieces) + " pieces!");
+    }
+    for (const TablebaseMaterial & material : tablebaseMaterials(maxPieces)) {
+        string path = directory + "/" + material.name() + ".lctb";
+        if (!ifstream(path)) {
+            if (material.size() >= invalidPosition) {
+                throw invalid_argument("Tablebase " + material.name() + " is too large!");
+            }
+            auto start = chrono::steady_clock::now();
+            vector<uint16_t> values = solveMaterial(material, threads, tablebase);
+            writeTablebaseFile(path, material, values);
+
+            size_t wins = count_if(values.begin(), values.end(), [](uint16_t v) { return (v & 3) == tbWin; });
+            size_t losses = count_if(values.begin(), values.end(), [](uint16_t v) { return (v & 3) == tbLoss; });
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            log << material.name() << ": " << values.size() << " entries, " << wins << " won, " << losses << " lost in " << seconds << " s" << endl;
+        }
+        tablebase.load(directory, material);
+    }
+}
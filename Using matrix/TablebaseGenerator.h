@@ -0,0 +1,32 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Tablebase generator header file
+*/
+
+#ifndef TABLEBASEGENERATOR_H
+#define TABLEBASEGENERATOR_H
+
+#include <ostream>
+#include <string>
+#include "Tablebase.h"
+
+using namespace std;
+
+/**
+ * Builds the tables of every material with up to maxPieces pieces that is missing from directory,
+ * and loads them into tablebase. Each table is solved by retrograde analysis:
+ * 1. All positions are expanded once, in parallel. Moves that keep the material become edges
+ *    of a graph of predecessors, and moves that change it are looked up in the smaller tables.
+ * 2. Starting from the positions where the side to move has no moves (and has won), results are
+ *    passed back to the predecessors one distance at a time. A position is won when one move
+ *    reaches a lost position, and lost when every move reaches a won position.
+ * 3. Positions that are never reached this way are draws.
+ * The 50-move rule is ignored. Throws invalid_argument above maxTablebasePieces pieces.
+ */
+void generateTablebases(const string & directory, int maxPieces, int threads, Tablebase & tablebase, ostream & log);
+
+#endif //TABLEBASEGENERATOR_H
@@ -0,0 +1,284 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the tournament
+*/
+
+#include "Tournament.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+using namespace std;
+
+static const char * startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1";
+
+EngineSpec parseEngine(const string & text) {
+    EngineSpec spec;
+    spec.name = text;
+    vector<string> fields;
+    size_t start = 0;
+    for (size_t colon = text.find(':'); colon != string::npos; colon = text.find(':', start)) {
+        fields.push_back(text.substr(start, colon - start));
+        start = colon + 1;
+    }
+    fields.push_back(text.substr(start));
+
+    try {
+        if (fields[0] == "random" && fields.size() == 1) {
+            spec.type = engineRandom;
+            return spec;
+        }
+        if (fields[0] == "smart" && fields.size() == 1) {
+            spec.type = engineSmart;
+            return spec;
+        }
+        if (fields[0] == "search" && (fields.size() == 2 || fields.size() == 3)) {
+            spec.type = engineSearch;
+            spec.search.depth = stoi(fields[1]);
+            spec.search.milliseconds = fields.size() == 3 ? stoi(fields[2]) : 0;
+            if (spec.search.depth > 0 && spec.search.depth < maxPly && spec.search.milliseconds >= 0) return spec;
+        }
+        if (fields[0] == "mcts" && fields.size() == 2) {
+            spec.type = engineMcts;
+            spec.mcts.playouts = stoull(fields[1]);
+            spec.mcts.seconds = 3600;       // the playouts decide
+            if (spec.mcts.playouts > 0) return spec;
+        }
+    } catch (logic_error &) {
+        // stoi failed, reported below
+    }
+    throw invalid_argument("Unknown engine " + text + "! Use random, smart, search:<depth>[:<milliseconds>] or mcts:<playouts>");
+}
+
+/**
+ * One engine of a worker thread. Searching engines keep their own table,
+ * cleared before every game so games do not depend on the ones before.
+ */
+class TournamentPlayer {
+public:
+    TournamentPlayer(const EngineSpec & spec, const Tablebase * tablebase, const atomic<bool> * stop) : m_spec(spec) {
+        m_spec.search.tablebase = tablebase;
+        m_spec.search.stop = stop;
+        if (spec.type == engineSearch) m_tt = make_unique<TranspositionTable>(spec.search.hash_mb);
+    }
+
+    void newGame(ChessBoard & board) {
+        if (m_tt) {
+            m_tt->clear();
+            m_search = make_unique<Search>(board, *m_tt);
+        }
+        if (m_spec.type == engineMcts) m_mcts = make_unique<Mcts>();
+    }
+
+    // Plays a move for the side to move. Returns false if it has none, i.e. has won
+    bool play(ChessBoard & board) {
+        bool is_white = board.whiteToMove();
+        if (m_spec.type == engineRandom) return board.randomAI(is_white);
+        if (m_spec.type == engineSmart) return board.smartAI(is_white);
+        if (m_spec.type == engineSearch) {
+            SearchResult result = m_search->think(m_spec.search);
+            if (!result.has_move) return false;
+            board.makeMove(result.best_move);
+            return true;
+        }
+        MctsResult result = m_mcts->think(board, m_spec.mcts);
+        if (!result.has_move) return false;
+        board.makeMove(result.best_move);
+        return true;
+    }
+
+private:
+    EngineSpec m_spec;
+    unique_ptr<TranspositionTable> m_tt;
+    unique_ptr<Search> m_search;
+    unique_ptr<Mcts> m_mcts;
+};
+
+// Sets up the start of both games of a pair: the opening and the random moves after it.
+// Returns false if the game ended during the random moves
+static bool setupPair(const TournamentOptions & options, uint64_t pair, Xoshiro256 & random, ChessBoard & board, vector<ChessMove> & moves) {
+    board.setFen(options.openings.empty() ? startPosition : options.openings[pair % options.openings.size()]);
+    for (int ply = 0; ply < options.random_plies; ply++) {
+        board.generateMoves(board.whiteToMove(), moves);
+        if (moves.empty()) {
+            return false;
+        }
+        board.makeMove(moves[random.below(moves.size())]);
+    }
+    board.generateMoves(board.whiteToMove(), moves);
+    return !moves.empty();
+}
+
+// Plays one game from the position on the board. Returns 1 if white wins, -1 if black wins and 0 for a draw.
+// The game is given up when stop is set
+static int playGame(const TournamentOptions & options, ChessBoard & board, TournamentPlayer & white, TournamentPlayer & black, const atomic<bool> & stop) {
+    white.newGame(board);
+    black.newGame(board);
+    for (int ply = 0; ply < options.max_plies; ply++) {
+        if (board.getHalfmoveClock() >= 100 || stop) {
+            return 0;
+        }
+        TablebaseProbe probe;
+        if (options.tablebase != nullptr && options.tablebase->probe(board, probe)) {
+            if (probe.result == tbDraw) return 0;
+            return (probe.result == tbWin) == board.whiteToMove() ? 1 : -1;
+        }
+        bool whiteToMove = board.whiteToMove();
+        if (!(whiteToMove ? white : black).play(board)) { // The side to move has no pieces or no moves and wins
+            return whiteToMove ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+double eloFromScore(double score) {
+    score = clamp(score, 1e-6, 1 - 1e-6);
+    return -400 * log10(1 / score - 1);
+}
+
+double scoreFromElo(double elo) {
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+double SprtOptions::lowerBound() const {
+    return log(beta / (1 - alpha));
+}
+
+double SprtOptions::upperBound() const {
+    return log((1 - beta) / alpha);
+}
+
+// Mean and variance of the score of a pair, scaled to [0, 1]. The mean is that of the pairs played.
+// For the variance every count gets another half pair, so it is not close to zero after a few pairs
+// with the same score. This matters less and less as the pairs come in
+static void pairScoreStats(const uint64_t pentanomial[5], double & mean, double & variance) {
+    double pairs = 0;
+    mean = 0;
+    for (int i = 0; i < 5; i++) {
+        pairs += pentanomial[i];
+        mean += pentanomial[i] * i / 4.0;
+    }
+    mean /= pairs;
+    variance = 0;
+    for (int i = 0; i < 5; i++) {
+        variance += (pentanomial[i] + 0.5) * (i / 4.0 - mean) * (i / 4.0 - mean);
+    }
+    variance /= pairs + 2.5;
+}
+
+double sprtLlr(const uint64_t pentanomial[5], double elo0, double elo1) {
+    uint64_t pairs = 0;
+    for (int i = 0; i < 5; i++) pairs += pentanomial[i];
+    if (pairs == 0) return 0;
+
+    double mean, variance;
+    pairScoreStats(pentanomial, mean, variance);
+    double score0 = scoreFromElo(elo0);
+    double score1 = scoreFromElo(elo1);
+    return pairs * (score1 - score0) * (2 * mean - score0 - score1) / (2 * variance);
+}
+
+double TournamentResult::score() const {
+    return games() > 0 ? (wins + draws / 2.0) / games() : 0.5;
+}
+
+double TournamentResult::elo() const {
+    if (games() > 0 && (wins == games() || losses == games())) {
+        return wins > 0 ? numeric_limits<double>::infinity() : -numeric_limits<double>::infinity();
+    }
+    return eloFromScore(score());
+}
+
+// From the variance of the score of a pair when all games were played in pairs,
+// otherwise from the variance of the result of a game
+double TournamentResult::eloError() const {
+    if (games() == 0) return 0;
+    uint64_t pairs = 0;
+    for (int i = 0; i < 5; i++) pairs += pentanomial[i];
+
+    double mean = score();
+    double error;
+    if (2 * pairs == games()) {
+        double pairMean, variance;
+        pairScoreStats(pentanomial, pairMean, variance);
+        error = 1.96 * sqrt(variance / pairs);
+    } else {
+        double variance = (wins * (1 - mean) * (1 - mean) + draws * (0.5 - mean) * (0.5 - mean) + losses * mean * mean) / games();
+        error = 1.96 * sqrt(variance / games());
+    }
+    return (eloFromScore(mean + error) - eloFromScore(mean - error)) / 2;
+}
+
+TournamentResult runTournament(const EngineSpec & first, const EngineSpec & second, const TournamentOptions & options, ostream & log) {
+    auto start = chrono::steady_clock::now();
+    atomic<uint64_t> nextPair{0};
+    atomic<bool> stop{false};
+    TournamentResult result;
+    mutex resultMutex;
+    uint64_t pairs = (options.games + 1) / 2;
+
+    runThreads(options.threads, [&](int) {
+        ChessBoard board;
+        TournamentPlayer firstPlayer(first, options.tablebase, &stop);
+        TournamentPlayer secondPlayer(second, options.tablebase, &stop);
+        vector<ChessMove> moves;
+        for (uint64_t pair = nextPair++; pair < pairs && !stop; pair = nextPair++) {
+            int results[2];
+            uint64_t played = 0;
+            for (uint64_t game = 2 * pair; game < min(2 * pair + 2, options.games); game++) {
+                // Both games of a pair start alike, then the moves of each game get their own seed
+                Xoshiro256 random(options.seed ^ (pair * 0x9E3779B97F4A7C15ULL));
+                for (int attempt = 0; !setupPair(options, pair, random, board, moves); attempt++) {
+                    if (attempt == 100) throw runtime_error("No random moves found after opening " + to_string(pair) + "!");
+                }
+                ChessBoard::seedAI(options.seed ^ ((game + 1) * 0xBF58476D1CE4E5B9ULL));
+
+                bool firstIsWhite = game % 2 == 0;
+                int gameResult = firstIsWhite ? playGame(options, board, firstPlayer, secondPlayer, stop)
+                                              : playGame(options, board, secondPlayer, firstPlayer, stop);
+                results[played++] = firstIsWhite ? gameResult : -gameResult;
+            }
+
+            lock_guard<mutex> lock(resultMutex);
+            if (stop) {
+                break;      // the test decided while this pair was played
+            }
+            for (uint64_t i = 0; i < played; i++) {
+                (results[i] > 0 ? result.wins : results[i] < 0 ? result.losses : result.draws)++;
+            }
+            if (played == 2) {
+                result.pentanomial[results[0] + results[1] + 2]++;
+            }
+            if (options.sprt.enabled) {
+                result.llr = sprtLlr(result.pentanomial, options.sprt.elo0, options.sprt.elo1);
+                if (result.llr >= options.sprt.upperBound()) result.sprt = 1;
+                if (result.llr <= options.sprt.lowerBound()) result.sprt = -1;
+                stop = result.sprt != 0;
+            }
+
+            uint64_t finished = result.games();
+            if (finished / 100 != (finished - played) / 100) {
+                double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                log << finished << " games, " << result.wins << " wins, " << result.losses << " losses, " << result.draws << " draws, ";
+                if (options.sprt.enabled) log << "LLR " << result.llr << ", ";
+                log << finished / seconds << " games/s" << endl;
+            }
+        }
+    }, [&]() { stop = true; });
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,110 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Tournament header file
+*/
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Mcts.h"
+#include "Search.h"
+
+using namespace std;
+
+class Tablebase;
+
+enum EngineType {
+    engineRandom,
+    engineSmart,
+    engineSearch,
+    engineMcts
+};
+
+// One of the AIs, as given on the command line
+struct EngineSpec {
+    string name;
+    EngineType type = engineRandom;
+    SearchLimits search;
+    MctsLimits mcts;
+};
+
+/**
+ * Parses an engine: "random", "smart", "search:<depth>", "search:<depth>:<milliseconds>"
+ * or "mcts:<playouts>". Throws invalid_argument for anything else.
+ */
+EngineSpec parseEngine(const string & text);
+
+/**
+ * Sequential probability ratio test between H0: the Elo difference is elo0 and H1: it is elo1.
+ * The test accepts H1 once the log-likelihood ratio reaches upperBound(), and H0 once it falls
+ * to lowerBound(). alpha and beta are the chances of accepting H1 or H0 when the other is true.
+ */
+struct SprtOptions {
+    bool enabled = false;
+    double elo0 = 0;
+    double elo1 = 5;
+    double alpha = 0.05;
+    double beta = 0.05;
+
+    double lowerBound() const;
+    double upperBound() const;
+};
+
+struct TournamentOptions {
+    uint64_t games = 100;
+    int threads = 1;
+    int random_plies = 4;           // random moves after the opening, the same for both games of a pair
+    int max_plies = 400;            // games still going after this many plies are draws
+    uint64_t seed = 1;              // game n is played with a seed made from this and n
+    vector<string> openings;        // FEN positions to start from in turn, the normal start position if empty
+    const Tablebase * tablebase = nullptr;  // ends games as soon as their result is known
+    SprtOptions sprt;               // stops the games once the test decides, games is then the most that are played
+};
+
+// Results from the point of view of the first engine
+struct TournamentResult {
+    uint64_t wins = 0;
+    uint64_t losses = 0;
+    uint64_t draws = 0;
+    uint64_t pentanomial[5] = {};   // pairs of games by the points of the first engine: 0, 0.5, 1, 1.5 and 2
+    double llr = 0;                 // log-likelihood ratio of the SPRT
+    int sprt = 0;                   // 1 if the SPRT accepted H1, -1 if it accepted H0, 0 if undecided
+    double seconds = 0;
+
+    uint64_t games() const { return wins + losses + draws; }
+    double score() const;           // draws count half
+    double elo() const;             // infinite if one engine scored every point
+    double eloError() const;        // half the width of the 95% confidence interval
+};
+
+// Elo difference of a score between 0 and 1, and the other way round
+double eloFromScore(double score);
+double scoreFromElo(double elo);
+
+/**
+ * Log-likelihood ratio of the SPRT from the pentanomial counts. The score of a pair is taken to
+ * be normally distributed, with the variance measured from the pairs (generalized SPRT), so
+ * the correlation between the two games of a pair is accounted for.
+ */
+double sprtLlr(const uint64_t pentanomial[5], double elo0, double elo1);
+
+/**
+ * Plays games between two engines on several threads, each with its own board and engines.
+ * Games come in pairs that start from the same position with the colours swapped, so an
+ * unbalanced opening favours neither engine. The first engine is white in even games.
+ * The random moves of every game are seeded from options.seed and the game number, so
+ * runs can be repeated. Progress is written to log every 100 games.
+ * With options.sprt enabled the test is updated after every pair and the run stops as soon
+ * as it decides. Pairs still being played then are left out of the result.
+ */
+TournamentResult runTournament(const EngineSpec & first, const EngineSpec & second, const TournamentOptions & options, ostream & log);
+
+#endif //TOURNAMENT_H
@@ -0,0 +1,148 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the training data shards
+*/
+
+#include "TrainingData.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+static const char fileMagic[8] = {'L', 'C', 'D', 'A', 'T', 'A', '0', '1'};
+static const size_t maxQueuedShards = 2;
+
+// File name without the directory
+static string baseName(const string & path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == string::npos ? path : path.substr(slash + 1);
+}
+
+ShardWriter::ShardWriter(const string & prefix, size_t samplesPerShard) :
+    m_prefix(prefix), m_shard_size(samplesPerShard), m_index(prefix + ".index", ios::trunc) {
+    if (!m_index) {
+        throw runtime_error("Could not create " + prefix + ".index.");
+    }
+    m_current.reserve(m_shard_size);
+    m_writer = thread(&ShardWriter::writerLoop, this);
+}
+
+ShardWriter::~ShardWriter() {
+    try {
+        finish();
+    } catch (...) {
+        // Errors are only reported by an explicit finish()
+    }
+}
+
+void ShardWriter::write(const vector<TrainingSample> & samples) {
+    unique_lock<mutex> lock(m_mutex);
+    if (m_error) {
+        rethrow_exception(m_error);
+    }
+    for (const TrainingSample & sample : samples) {
+        m_current.push_back(sample);
+        if (m_current.size() == m_shard_size) {
+            // Take the full shard out before waiting, as other threads fill the next one meanwhile
+            vector<TrainingSample> shard = move(m_current);
+            m_current = vector<TrainingSample>();
+            m_current.reserve(m_shard_size);
+            m_space.wait(lock, [this]() { return m_full.size() < maxQueuedShards || m_error; });
+            if (m_error) {
+                rethrow_exception(m_error);
+            }
+            m_full.push_back(move(shard));
+            m_ready.notify_one();
+        }
+    }
+    m_samples += samples.size();
+}
+
+void ShardWriter::finish() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_done) {
+            return;
+        }
+        if (!m_current.empty()) {
+            m_full.push_back(move(m_current));
+            m_current.clear();
+        }
+        m_done = true;
+    }
+    m_ready.notify_one();
+    m_writer.join();
+    if (m_error) {
+        rethrow_exception(m_error);
+    }
+}
+
+// Write shards as they fill up, until finish() has been called and the queue is empty
+void ShardWriter::writerLoop() {
+    while (true) {
+        vector<TrainingSample> shard;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_ready.wait(lock, [this]() { return !m_full.empty() || m_done; });
+            if (m_full.empty()) {
+                return;
+            }
+            shard = move(m_full.front());
+            m_full.pop_front();
+        }
+        m_space.notify_all();
+
+        try {
+            string path = m_prefix + "-" + to_string(m_shards++) + ".lcd";
+            ofstream file(path, ios::binary | ios::trunc);
+            file.write(fileMagic, sizeof(fileMagic));
+            file.write(reinterpret_cast<const char *>(shard.data()), shard.size() * sizeof(TrainingSample));
+            file.close();
+            if (!file) {
+                throw runtime_error("Could not write " + path + ".");
+            }
+            m_index << baseName(path) << " " << shard.size() << endl;
+        } catch (...) {
+            lock_guard<mutex> lock(m_mutex);
+            m_error = current_exception();
+            m_full.clear();
+            m_space.notify_all();
+            return;
+        }
+    }
+}
+
+ShardReader::ShardReader(const string & path) : m_file(path) {
+    if (m_file.size() < sizeof(fileMagic) || memcmp(m_file.data(), fileMagic, sizeof(fileMagic)) != 0 ||
+        (m_file.size() - sizeof(fileMagic)) % sizeof(TrainingSample) != 0) {
+        throw invalid_argument(path + " is not a training data shard.");
+    }
+    m_samples = reinterpret_cast<const TrainingSample *>(m_file.data() + sizeof(fileMagic));
+    m_size = (m_file.size() - sizeof(fileMagic)) / sizeof(TrainingSample);
+}
+
+vector<string> readShardIndex(const string & indexPath) {
+    ifstream index(indexPath);
+    if (!index) {
+        throw runtime_error("Could not open " + indexPath + ".");
+    }
+    size_t slash = indexPath.find_last_of("/\\");
+    string directory = slash == string::npos ? "" : indexPath.substr(0, slash + 1);
+
+    vector<string> shards;
+    string line;
+    while (getline(index, line)) {
+        istringstream fields(line);
+        string name;
+        if (fields >> name) {
+            shards.push_back(directory + name);
+        }
+    }
+    return shards;
+}
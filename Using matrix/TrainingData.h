@@ -0,0 +1,94 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Training data header file
+*/
+
+#ifndef TRAININGDATA_H
+#define TRAININGDATA_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MappedFile.h"
+#include "PackedPosition.h"
+
+using namespace std;
+
+// A position with the score of a search and the result of the game it was played in
+struct TrainingSample {
+    PackedPosition position;
+    int16_t score;          // centipawns from the point of view of the side to move
+    int8_t result;          // 1 if white won the game, -1 if black won, 0 for a draw
+    uint8_t reserved;
+    uint16_t ply;           // plies since the start of the game
+    uint16_t reserved2;
+};
+static_assert(sizeof(TrainingSample) == 40, "TrainingSample must be 40 bytes");
+
+/**
+ * Collects samples from any number of threads into shards of a fixed number of samples.
+ * A full shard is handed to a writer thread, so the threads producing samples never wait
+ * for the disk unless the writer falls two shards behind. Shard files are named
+ * prefix-N.lcd and hold an 8 byte header "LCDATA01" followed by the samples. Every shard
+ * gets a line "file samples" in the index prefix.index once it is written.
+ */
+class ShardWriter {
+public:
+    explicit ShardWriter(const string & prefix, size_t samplesPerShard = 1 << 20);
+    ShardWriter(const ShardWriter & other) = delete;
+    ShardWriter & operator=(const ShardWriter & other) = delete;
+    ~ShardWriter();
+
+    void write(const vector<TrainingSample> & samples);     // thread safe
+    // Write the last shard, even if it is not full, and wait for the writer. Rethrows its errors
+    void finish();
+    uint64_t samples() const { return m_samples; }
+
+private:
+    void writerLoop();
+
+    string m_prefix;
+    size_t m_shard_size;
+    mutex m_mutex;
+    condition_variable m_ready;         // a shard is waiting for the writer, or finish() was called
+    condition_variable m_space;         // the writer took a shard from the queue
+    vector<TrainingSample> m_current;
+    deque<vector<TrainingSample>> m_full;
+    bool m_done = false;
+    atomic<uint64_t> m_samples{0};
+    int m_shards = 0;
+    ofstream m_index;
+    exception_ptr m_error;
+    thread m_writer;
+};
+
+/**
+ * One shard, read through a memory mapping.
+ */
+class ShardReader {
+public:
+    explicit ShardReader(const string & path);
+    size_t size() const { return m_size; }
+    const TrainingSample & operator[](size_t index) const { return m_samples[index]; }
+
+private:
+    MappedFile m_file;
+    const TrainingSample * m_samples;
+    size_t m_size;
+};
+
+// Paths of the shards listed in an index, relative to the directory of the index
+vector<string> readShardIndex(const string & indexPath);
+
+#endif //TRAININGDATA_H
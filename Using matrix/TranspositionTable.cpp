@@ -0,0 +1,126 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the transposition table
+*/
+
+#include "TranspositionTable.h"
+
+using namespace std;
+
+TranspositionTable::TranspositionTable(size_t sizeMB) {
+    resize(sizeMB);
+}
+
+// Allocate the largest power of two number of buckets that fits in sizeMB
+void TranspositionTable::resize(size_t sizeMB) {
+    size_t nrBuckets = 1;
+    while (nrBuckets * 2 * sizeof(Bucket) <= sizeMB * 1024 * 1024) {
+        nrBuckets *= 2;
+    }
+    m_buckets.reset(new Bucket[nrBuckets]);
+    m_mask = nrBuckets - 1;
+    m_size_mb = sizeMB;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= m_mask; i++) {
+        for (Entry & entry : m_buckets[i].entries) {
+            entry.key_xor_data.store(0, memory_order_relaxed);
+            entry.data.store(0, memory_order_relaxed);
+        }
+    }
+    m_generation.store(0, memory_order_relaxed);
+}
+
+void TranspositionTable::newSearch() {
+    m_generation.store((m_generation.load(memory_order_relaxed) + 1) & 63, memory_order_relaxed);
+}
+
+// Data layout: move (16 bits), score (16), depth (8), bound (2), generation (6)
+uint64_t TranspositionTable::encode(const TTData & data, uint8_t generation) {
+    return uint64_t(data.move)
+         | uint64_t(uint16_t(data.score)) << 16
+         | uint64_t(uint8_t(data.depth)) << 32
+         | uint64_t(data.bound) << 40
+         | uint64_t(generation) << 42;
+}
+
+TTData TranspositionTable::decode(uint64_t data) {
+    TTData result;
+    result.move = static_cast<uint16_t>(data);
+    result.score = static_cast<int16_t>(data >> 16);
+    result.depth = static_cast<int8_t>(data >> 32);
+    result.bound = static_cast<Bound>((data >> 40) & 3);
+    return result;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData & data) const {
+    const Bucket & bucket = m_buckets[key & m_mask];
+    for (const Entry & entry : bucket.entries) {
+        uint64_t stored = entry.data.load(memory_order_relaxed);
+        if ((entry.key_xor_data.load(memory_order_relaxed) ^ stored) == key && stored != 0) {
+            data = decode(stored);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Replace the entry of the same position, or else the least valuable entry of the bucket
+void TranspositionTable::store(uint64_t key, const TTData & data) {
+    Bucket & bucket = m_buckets[key & m_mask];
+    const uint8_t generation = m_generation.load(memory_order_relaxed);
+    Entry * replace = nullptr;
+    int replaceValue = 1 << 30;
+
+    for (Entry & entry : bucket.entries) {
+        uint64_t stored = entry.data.load(memory_order_relaxed);
+        if ((entry.key_xor_data.load(memory_order_relaxed) ^ stored) == key) {
+            TTData old = decode(stored);
+            // Keep a deeper result of the same position unless the new one is exact
+            if (data.bound != boundExact && old.depth > data.depth + 2 && generationOf(stored) == generation) {
+                return;
+            }
+            replace = &entry;
+            break;
+        }
+        // Value of an entry: its depth, lowered by 8 for every search since it was stored
+        int age = (generation - generationOf(stored)) & 63;
+        int value = static_cast<int8_t>(stored >> 32) - 8 * age;
+        if (value < replaceValue) {
+            replaceValue = value;
+            replace = &entry;
+        }
+    }
+
+    TTData toStore = data;
+    if (toStore.move == 0) { // Keep the old move if the new result has none
+        uint64_t stored = replace->data.load(memory_order_relaxed);
+        if ((replace->key_xor_data.load(memory_order_relaxed) ^ stored) == key) {
+            toStore.move = decode(stored).move;
+        }
+    }
+    uint64_t encoded = encode(toStore, generation);
+    replace->key_xor_data.store(key ^ encoded, memory_order_relaxed);
+    replace->data.store(encoded, memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t nrBuckets = m_mask + 1 < 250 ? m_mask + 1 : 250;
+    const uint8_t generation = m_generation.load(memory_order_relaxed);
+    int used = 0;
+    for (size_t i = 0; i < nrBuckets; i++) {
+        for (const Entry & entry : m_buckets[i].entries) {
+            uint64_t stored = entry.data.load(memory_order_relaxed);
+            if (stored != 0 && generationOf(stored) == generation) {
+                used++;
+            }
+        }
+    }
+    return used * 1000 / int(nrBuckets * 4);
+}
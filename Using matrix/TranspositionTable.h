@@ -0,0 +1,88 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Transposition table header file
+*/
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "ChessMove.h"
+
+using namespace std;
+
+// Kind of score stored in an entry
+enum Bound : uint8_t {
+    boundNone = 0,
+    boundUpper = 1,     // score is at most the stored value (no move raised alpha)
+    boundLower = 2,     // score is at least the stored value (beta cutoff)
+    boundExact = 3
+};
+
+struct TTData {
+    uint16_t move = 0;      // packed with packMove(), 0 if none
+    int16_t score = 0;
+    int8_t depth = 0;
+    Bound bound = boundNone;
+};
+
+// 15-bit move: from square, to square and promotion piece
+inline uint16_t packMove(const ChessMove & move) {
+    int promotion = 0;
+    switch (move.promotion) {
+        case 'n': promotion = 1; break;
+        case 'b': promotion = 2; break;
+        case 'r': promotion = 3; break;
+        case 'q': promotion = 4; break;
+    }
+    return static_cast<uint16_t>((move.from_x * 8 + move.from_y) | ((move.to_x * 8 + move.to_y) << 6) | (promotion << 12));
+}
+
+/**
+ * Fixed-size table of searched positions keyed by the Zobrist hash.
+ * Entries are 16 bytes and grouped 4 to a 64 byte bucket, so a probe touches a
+ * single cache line. The table may be shared by several search threads without
+ * locks: an entry stores (key XOR data) next to data, so an entry torn by two
+ * concurrent writers fails verification and is treated as missing.
+ */
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t sizeMB = 16);
+
+    void resize(size_t sizeMB);     // rounds down to a power of two number of buckets
+    void clear();
+    void newSearch();               // older entries are replaced first
+    size_t sizeMB() const { return m_size_mb; }
+
+    bool probe(uint64_t key, TTData & data) const;
+    void store(uint64_t key, const TTData & data);
+
+    // Entries per mille used by the current search, from a sample of the table
+    int hashfull() const;
+
+private:
+    struct Entry {
+        atomic<uint64_t> key_xor_data;
+        atomic<uint64_t> data;
+    };
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    static uint64_t encode(const TTData & data, uint8_t generation);
+    static TTData decode(uint64_t data);
+    static uint8_t generationOf(uint64_t data) { return (data >> 42) & 63; }
+
+    unique_ptr<Bucket[]> m_buckets;
+    size_t m_mask = 0;
+    size_t m_size_mb = 0;
+    atomic<uint8_t> m_generation{0};       // a pondering search may start a new search while another one stores
+};
+
+#endif //TRANSPOSITIONTABLE_H
@@ -0,0 +1,197 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of the evaluation tuner
+*/
+
+#include "Tuner.h"
+#include "ChessBoard.h"
+#include "ChessPiece.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static const char pieceTypes[] = "pnbrqk";
+static const int samplesPerBatch = 4096;
+static const int mobilityWeight = 6 + 6 * 64;
+static const int tempoWeight = mobilityWeight + 1;
+
+vector<double> evalWeights(const EvalParams & params) {
+    vector<double> weights;
+    weights.reserve(nrEvalWeights);
+    weights.insert(weights.end(), begin(params.material), end(params.material));
+    for (const auto & table : params.psq) {
+        weights.insert(weights.end(), begin(table), end(table));
+    }
+    weights.push_back(params.mobility);
+    weights.push_back(params.tempo);
+    return weights;
+}
+
+EvalParams evalParamsFrom(const vector<double> & weights) {
+    EvalParams params;
+    int i = 0;
+    for (int & value : params.material) value = lround(weights[i++]);
+    for (auto & table : params.psq) {
+        for (int & value : table) value = lround(weights[i++]);
+    }
+    params.mobility = lround(weights[i++]);
+    params.tempo = lround(weights[i++]);
+    return params;
+}
+
+// The same terms as evaluatePosition(), seen from white
+void countEvalFeatures(ChessBoard & board, vector<ChessMove> & moves, int counts[]) {
+    for (bool is_white : {true, false}) {
+        for (ChessPiece * piece : is_white ? board.getWhitePieces() : board.getBlackPieces()) {
+            int type = strchr(pieceTypes, tolower(piece->getLatin1Representation())) - pieceTypes;
+            int x = is_white ? piece->getX() : 7 - piece->getX();
+            counts[type] += is_white ? -1 : 1;
+            counts[6 + type * 64 + x * 8 + piece->getY()] += is_white ? 1 : -1;
+        }
+    }
+    int sign = board.whiteToMove() ? 1 : -1;
+    board.generateMoves(board.whiteToMove(), moves);
+    counts[mobilityWeight] += sign * static_cast<int>(moves.size());
+    counts[tempoWeight] += sign;
+}
+
+TexelTuner::TexelTuner(int threads) : m_threads(max(threads, 1)) {}
+
+void TexelTuner::addShard(const ShardReader & shard) {
+    size_t nrBatches = (shard.size() + samplesPerBatch - 1) / samplesPerBatch;
+    vector<Batch> batches(nrBatches);
+    parallelFor(nrBatches, m_threads, 1, [&](size_t b, size_t, int) {
+        Batch & batch = batches[b];
+        ChessBoard board;
+        vector<ChessMove> moves;
+        int counts[nrEvalWeights] = {};
+        size_t end = min(shard.size(), (b + 1) * samplesPerBatch);
+        for (size_t i = b * samplesPerBatch; i < end; i++) {
+            const TrainingSample & sample = shard[i];
+            unpackBoard(sample.position, board);
+            bool whiteToMove = board.whiteToMove();
+            countEvalFeatures(board, moves, counts);
+
+            for (int weight = 0; weight < nrEvalWeights; weight++) {
+                if (counts[weight] != 0) {
+                    batch.weights.push_back(weight);
+                    batch.counts.push_back(counts[weight]);
+                    counts[weight] = 0;
+                }
+            }
+            batch.offsets.push_back(batch.weights.size());
+            batch.results.push_back((sample.result + 1) / 2.0f);
+            batch.scores.push_back(whiteToMove ? sample.score : -sample.score);
+        }
+    });
+    for (Batch & batch : batches) {
+        m_batches.push_back(move(batch));
+    }
+    m_size += shard.size();
+}
+
+void TexelTuner::addIndex(const string & indexPath) {
+    for (const string & path : readShardIndex(indexPath)) {
+        addShard(ShardReader(path));
+    }
+}
+
+// Expected result for white of an evaluation in centipawns
+static double sigmoid(double score, double scale) {
+    return 1.0 / (1.0 + pow(10.0, -scale * score / 400.0));
+}
+
+double TexelTuner::evaluateBatches(const vector<double> & weights, double scale, double lambda, vector<double> * gradient) const {
+    vector<double> errors(m_threads, 0.0);
+    vector<vector<double>> gradients(gradient != nullptr ? m_threads : 0, vector<double>(nrEvalWeights, 0.0));
+    parallelFor(m_batches.size(), m_threads, 1, [&](size_t b, size_t, int threadId) {
+        const Batch & batch = m_batches[b];
+        double error = 0;
+        for (size_t i = 0; i + 1 < batch.offsets.size(); i++) {
+            double score = 0;
+            for (uint32_t e = batch.offsets[i]; e < batch.offsets[i + 1]; e++) {
+                score += weights[batch.weights[e]] * batch.counts[e];
+            }
+            double expected = sigmoid(score, scale);
+            double target = lambda * batch.results[i] + (1 - lambda) * sigmoid(batch.scores[i], scale);
+            error += (expected - target) * (expected - target);
+
+            if (gradient != nullptr) {
+                double slope = 2 * (expected - target) * expected * (1 - expected) * log(10.0) * scale / 400.0;
+                vector<double> & sum = gradients[threadId];
+                for (uint32_t e = batch.offsets[i]; e < batch.offsets[i + 1]; e++) {
+                    sum[batch.weights[e]] += slope * batch.counts[e];
+                }
+            }
+        }
+        errors[threadId] += error;
+    });
+
+    double total = 0;
+    for (double error : errors) total += error;
+    if (gradient != nullptr) {
+        gradient->assign(nrEvalWeights, 0.0);
+        for (const vector<double> & sum : gradients) {
+            for (int w = 0; w < nrEvalWeights; w++) (*gradient)[w] += sum[w] / m_size;
+        }
+    }
+    return m_size > 0 ? total / m_size : 0;
+}
+
+double TexelTuner::error(const vector<double> & weights, double scale, double lambda) const {
+    return evaluateBatches(weights, scale, lambda, nullptr);
+}
+
+double TexelTuner::fitScale(const vector<double> & weights, double lambda) {
+    double best = 1.0;
+    double bestError = error(weights, best, lambda);
+    for (double step = 0.5; step > 0.01; step /= 2) {
+        for (double candidate : {best - step, best + step}) {
+            if (candidate <= 0) continue;
+            double candidateError = error(weights, candidate, lambda);
+            if (candidateError < bestError) {
+                best = candidate;
+                bestError = candidateError;
+            }
+        }
+    }
+    return best;
+}
+
+EvalParams TexelTuner::tune(const EvalParams & start, const TunerOptions & options, ostream & log) {
+    if (m_size == 0) {
+        throw invalid_argument("There are no positions to tune on.");
+    }
+    vector<double> weights = evalWeights(start);
+    double scale = fitScale(weights, options.lambda);
+    log << m_size << " positions, scale " << scale << ", error " << error(weights, scale, options.lambda) << endl;
+
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    vector<double> gradient;
+    vector<double> moment(nrEvalWeights, 0.0);
+    vector<double> velocity(nrEvalWeights, 0.0);
+    for (int iteration = 1; iteration <= options.iterations; iteration++) {
+        double currentError = evaluateBatches(weights, scale, options.lambda, &gradient);
+        for (int w = 0; w < nrEvalWeights; w++) {
+            moment[w] = beta1 * moment[w] + (1 - beta1) * gradient[w];
+            velocity[w] = beta2 * velocity[w] + (1 - beta2) * gradient[w] * gradient[w];
+            double correctedMoment = moment[w] / (1 - pow(beta1, iteration));
+            double correctedVelocity = velocity[w] / (1 - pow(beta2, iteration));
+            weights[w] -= options.learning_rate * correctedMoment / (sqrt(correctedVelocity) + 1e-12);
+        }
+        if (iteration % 50 == 0 || iteration == options.iterations) {
+            log << "iteration " << iteration << ", error " << currentError << endl;
+        }
+    }
+    return evalParamsFrom(weights);
+}
@@ -0,0 +1,83 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Evaluation tuner header file
+*/
+
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ChessMove.h"
+#include "Evaluation.h"
+#include "TrainingData.h"
+
+using namespace std;
+
+// Number of weights in EvalParams: material, piece-square tables, mobility and tempo
+const int nrEvalWeights = 6 + 6 * 64 + 2;
+
+// EvalParams as one list of weights and back, in the order above
+vector<double> evalWeights(const EvalParams & params);
+EvalParams evalParamsFrom(const vector<double> & weights);
+
+/**
+ * Adds to counts how often each weight counts in the evaluation of the position from white's
+ * point of view, so the dot product with evalWeights() is evaluatePosition() seen from white.
+ * counts holds nrEvalWeights entries. moves is used to generate the moves of the side to move.
+ */
+void countEvalFeatures(ChessBoard & board, vector<ChessMove> & moves, int counts[]);
+
+struct TunerOptions {
+    int iterations = 500;
+    double learning_rate = 1.0;     // largest step of a weight per iteration, in centipawns (Adam)
+    double lambda = 1.0;            // weight of the game result in the target. The rest is the search score
+};
+
+/**
+ * Texel tuning of the handcrafted evaluation.
+ * The evaluation is linear in its weights, so each position is stored once as the sparse
+ * list of how often each weight counts for white (a few bytes per piece), and evaluating
+ * it is a dot product. Positions are kept in batches of a few thousand, which the threads
+ * evaluate in parallel. The error is the mean squared difference between the sigmoid of
+ * the evaluation and the result of the game, and it is minimised with Adam on the full gradient.
+ */
+class TexelTuner {
+public:
+    explicit TexelTuner(int threads);
+
+    // Add every sample of a shard. Samples are converted in parallel
+    void addShard(const ShardReader & shard);
+    void addIndex(const string & indexPath);
+    size_t size() const { return m_size; }
+
+    // Scale of the sigmoid that fits the given weights best, found by a scan and refinement
+    double fitScale(const vector<double> & weights, double lambda);
+    double error(const vector<double> & weights, double scale, double lambda) const;
+
+    EvalParams tune(const EvalParams & start, const TunerOptions & options, ostream & log);
+
+private:
+    struct Batch {
+        vector<uint32_t> offsets{0};    // the entries of position i are offsets[i] to offsets[i + 1]
+        vector<uint16_t> weights;       // weight of an entry
+        vector<int16_t> counts;         // and its coefficient, from white's point of view
+        vector<float> results;          // game result for white: 0, 0.5 or 1
+        vector<float> scores;           // search score for white, in centipawns
+    };
+
+    // Error of all batches, and its gradient if gradient is not null
+    double evaluateBatches(const vector<double> & weights, double scale, double lambda, vector<double> * gradient) const;
+
+    int m_threads;
+    size_t m_size = 0;
+    vector<Batch> m_batches;
+};
+
+#endif //TUNER_H
@@ -0,0 +1,50 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Implementation of Zobrist hashing
+*/
+
+#include "Zobrist.h"
+
+#include <cstring>
+
+// Keys for 12 piece types on 64 squares, and the side to move.
+// Generated with splitmix64 from a fixed seed so hashes are the same in every run
+struct ZobristKeys {
+    uint64_t pieces[12][64];
+    uint64_t blackToMove;
+
+    ZobristKeys() {
+        uint64_t state = 0x4C6F73696E67ULL;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (auto & piece : pieces) {
+            for (auto & key : piece) {
+                key = next();
+            }
+        }
+        blackToMove = next();
+    }
+};
+
+static const ZobristKeys keys;
+static const char pieceChars[] = "PNBRQKpnbrqk";
+
+uint64_t zobristPiece(char piece, int x, int y) {
+    const char * type = strchr(pieceChars, piece);
+    if (type == nullptr || piece == '\0') {
+        return 0;
+    }
+    return keys.pieces[type - pieceChars][x * 8 + y];
+}
+
+uint64_t zobristBlackToMove() {
+    return keys.blackToMove;
+}
@@ -0,0 +1,21 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Zobrist hashing header file
+*/
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// Random key of a piece (latin1 character) on a square
+uint64_t zobristPiece(char piece, int x, int y);
+
+// Key that is added when black is to move
+uint64_t zobristBlackToMove();
+
+#endif //ZOBRIST_H
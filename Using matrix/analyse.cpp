@@ -0,0 +1,116 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Position analysis
+*/
+
+#include "Search.h"
+#include "EpdFile.h"
+#include "Playout.h"
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o analyse.exe analyse.cpp EpdFile.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp MappedFile.cpp Search.cpp MoveOrdering.cpp TranspositionTable.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Tablebase.cpp Playout.cpp Random.cpp
+// Running:           ./analyse.exe [--info|--json] <lines> <milliseconds> <positions> [threads]
+//                    ./analyse.exe playouts <games> <positions> [threads]
+//
+// Reads a file with one FEN or EPD position per line and writes the best moves of each
+// with their scores and expected continuations, for example:
+//   1. e2e3 score 45: e2e3 b7b5 f1b5 ...
+// With playouts it plays random games from each position instead and writes how many
+// games per second the threads play, as the Monte Carlo tree search does.
+// --info writes the counters of the search after every iteration and for all threads at
+// the end, --json writes them as one JSON object per line instead.
+
+// The position as FEN followed by its EPD operations, such as its id
+static string describePosition(const FenPosition & position) {
+    string text = writeFen(position);
+    if (position.operations_length > 0) {
+        text += " " + string(position.operations, position.operations_length);
+    }
+    return text;
+}
+
+// Random games from each position, to measure the playout speed
+static void benchmarkPlayouts(EpdFile & positions, uint64_t games, int threads) {
+    ChessBoard board;
+    FenPosition position;
+    while (positions.next(position)) {
+        board.setPosition(position);
+        PlayoutStats stats = runPlayouts(board, games, threads, 1);
+        cout << describePosition(position) << "\n  " << stats.games << " games, " << stats.plies << " plies in " << int(stats.seconds * 1000) << " ms, "
+             << stats.gamesPerSecond() << " games/s with " << stats.threads << " threads" << endl;
+    }
+}
+
+int main(int argc, char * argv[]) {
+    // The options may come anywhere, the other arguments keep their order
+    bool info = false;
+    bool json = false;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--info") {
+            info = true;
+        } else if (arg == "--json") {
+            json = true;
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() < 3 || (args[0] == "playouts" && (info || json))) {
+        cerr << "Usage: " << argv[0] << " [--info|--json] <lines> <milliseconds> <positions> [threads]" << endl;
+        cerr << "       " << argv[0] << " playouts <games> <positions> [threads]" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        EpdFile positions(args[2]);
+        int threads = args.size() > 3 ? stoi(args[3]) : static_cast<int>(thread::hardware_concurrency());
+        if (args[0] == "playouts") {
+            benchmarkPlayouts(positions, stoull(args[1]), threads);
+            return EXIT_SUCCESS;
+        }
+
+        SearchLimits limits;
+        limits.multi_pv = stoi(args[0]);
+        limits.milliseconds = stoi(args[1]);
+        limits.depth = maxPly - 1;
+        limits.threads = threads;
+        limits.info = info || json ? &cout : nullptr;
+        limits.info_json = json;
+
+        ChessBoard board;
+        FenPosition position;
+        while (positions.next(position)) {
+            board.setPosition(position);
+            cout << describePosition(position) << endl;
+            Search search(board, searchTable(limits.hash_mb));
+            SearchResult result = search.think(limits);
+
+            if (!result.has_move) {
+                cout << "  No moves, the side to move has won\n";
+            }
+            for (size_t i = 0; i < result.lines.size(); i++) {
+                const SearchLine & line = result.lines[i];
+                cout << "  " << i + 1 << ". " << moveToString(line.moves[0]) << " score " << line.score << ":";
+                for (const ChessMove & move : line.moves) {
+                    cout << " " << moveToString(move);
+                }
+                cout << "\n";
+            }
+            cout << "  depth " << result.depth << ", " << result.nodes << " nodes" << endl;
+            if (limits.info != nullptr) { // the helper threads are only counted once they are done
+                cout << (json ? result.stats.json(result.threads, result.seconds) : result.stats.infoLine(result.threads, result.seconds)) << endl;
+            }
+        }
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
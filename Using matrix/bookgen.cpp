@@ -0,0 +1,35 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Opening book builder
+*/
+
+#include "OpeningBook.h"
+#include <iostream>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o bookgen.exe bookgen.cpp OpeningBook.cpp GameRecord.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp PackedPosition.cpp MappedFile.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Random.cpp
+// Running:           ./bookgen.exe <book> <max plies> <min games> <game files...>
+
+int main(int argc, char * argv[]) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0] << " <book> <max plies> <min games> <game files...>" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        BookBuilder builder(argv[1], stoi(argv[2]));
+        for (int i = 4; i < argc; i++) {
+            builder.addGameFile(argv[i]);
+        }
+        size_t entries = builder.finish(stoul(argv[3]));
+        cout << entries << " moves in " << argv[1] << endl;
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Self-play training data generator
+*/
+
+#include "SelfPlay.h"
+#include "EpdFile.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "Tablebase.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o datagen.exe datagen.cpp SelfPlay.cpp TrainingData.cpp EpdFile.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp PackedPosition.cpp MappedFile.cpp Search.cpp MoveOrdering.cpp TranspositionTable.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Tablebase.cpp Random.cpp
+// Running:           ./datagen.exe <prefix> <games> [threads] [depth] [process] [openings]
+//
+// Several processes, on one machine or many, each write their own shards and index when they
+// are given different process numbers. Their games use different seeds as well.
+// The openings file has one FEN or EPD position per line, lines starting with # are skipped.
+
+int main(int argc, char * argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <prefix> <games> [threads] [depth] [process] [openings]" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        SelfPlayOptions options;
+        options.games = stoull(argv[2]);
+        options.threads = argc > 3 ? stoi(argv[3]) : static_cast<int>(thread::hardware_concurrency());
+        options.depth = argc > 4 ? stoi(argv[4]) : options.depth;
+        int process = argc > 5 ? stoi(argv[5]) : 0;
+        options.seed = 0x5E1F9A7ULL + process;
+        if (argc > 6) {
+            options.openings = loadFens(argv[6]);
+        }
+
+        // The same weights, tables and network as main.cpp, if they are there
+        if (ifstream("evaluation.txt")) {
+            setEvalParams(loadEvalParams("evaluation.txt"));
+        }
+        Tablebase tablebase("tablebases", maxTablebasePieces);
+        if (tablebase.size() > 0) options.tablebase = &tablebase;
+        unique_ptr<Nnue> network;
+        if (ifstream("network.nnue")) {
+            network = make_unique<Nnue>("network.nnue");
+            options.nnue = network.get();
+        }
+
+        ShardWriter writer(string(argv[1]) + "-p" + to_string(process));
+        SelfPlayStats stats = runSelfPlay(options, writer, cout);
+        writer.finish();
+        cout << stats.games << " games (" << stats.white_wins << " white wins, " << stats.black_wins << " black wins, "
+             << stats.draws << " draws), " << stats.samples << " positions, " << stats.gamesPerSecond() << " games/s" << endl;
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
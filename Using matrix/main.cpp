@@ -7,13 +7,21 @@
   Main file
 */
 #include "ChessBoard.h"
+#include "EngineAI.h"
+#include "GameRecord.h"
+#include "Tablebase.h"
+#include "OpeningBook.h"
+#include "Evaluation.h"
+#include <fstream>
+#include <random>
 #include <iostream> 
 #include <sstream>  
 #include <vector>   
+#include <thread>
 
 using namespace std;
 
-// Compiling:         g++ -o main.exe main.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp
+// Compiling:         g++ -o main.exe main.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp PackedPosition.cpp MappedFile.cpp GameRecord.cpp Search.cpp Mcts.cpp MoveOrdering.cpp TranspositionTable.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Ponder.cpp Tablebase.cpp Playout.cpp Random.cpp OpeningBook.cpp EngineAI.cpp
 // Testing for leaks: valgrind --leak-check=full --show-leak-kinds=all ./main.exe
 
 // Checks if the line consists of exactly 8 correct characters
@@ -29,7 +37,33 @@ bool checkValidLine(string& line) {
     return true; // All characters are valid
 }
 
+// Lets the selected type of AI make a move. Returns false if it has no moves.
+// The searching AIs play from the opening book while the position is in it. The search AI ponders if given a ponderer,
+// and the MCTS AI searches with the tree of its player
+bool playAI(ChessBoard& cb, int aiType, bool is_white, const SearchLimits& limits, const MctsLimits& mctsLimits, const OpeningBook* book, Ponderer* ponderer, Mcts* mcts) {
+    if (aiType >= 2 && book != nullptr) {
+        static Xoshiro256 bookRandom(random_device{}());
+        cb.setWhiteToMove(is_white);
+        ChessMove move;
+        if (book->pickMove(cb, bookRandom, move)) {
+            if (ponderer != nullptr) ponderer->stop();
+            cb.makeMove(move);
+            cout << "Book move \n";
+            return true;
+        }
+    }
+    if (aiType == 3) return mctsAI(cb, is_white, *mcts, mctsLimits);
+    if (aiType == 2) return searchAI(cb, is_white, limits, ponderer);
+    if (aiType == 1) return cb.smartAI(is_white);
+    return cb.randomAI(is_white);
+}
+
 int main() {
+    // Weights made with tune.exe replace the default evaluation. Loaded before any board is set up
+    if (ifstream("evaluation.txt")) {
+        setEvalParams(loadEvalParams("evaluation.txt"));
+    }
+
     cout << "Welcome to losing chess with AI! \n";
     cout << "Select board option:  \n";
     cout << "1: Use default chess board \n";
@@ -114,35 +148,111 @@ int main() {
     }
     cout << "\n";
     
-    // 4. Select types of AI. 0 = random, 1 = smart
-    cout << "Time to select the AI players. There are two types of AI: \n";
+    // 4. Select types of AI. 0 = random, 1 = smart, 2 = search, 3 = Monte Carlo tree search
+    cout << "Time to select the AI players. There are four types of AI: \n";
     cout << "- AI 0: Random thinker \n";
     cout << "- AI 1: Thinks one step ahead \n";
+    cout << "- AI 2: Searches several moves ahead \n";
+    cout << "- AI 3: Plays many random games from each move \n";
 
-    bool playerOneType;
+    int playerOneType;
     while(true){
-        cout << "Select AI type for player 1: 0 or 1? \n";
-        cin >> playerOneType;
-        if(playerOneType == 0 || playerOneType == 1){
+        cout << "Select AI type for player 1: 0, 1, 2 or 3? \n";
+        if((cin >> playerOneType) && playerOneType >= 0 && playerOneType <= 3){
             break; 
         }
         else {
-            cout << "Incorrect input. Please enter 0 or 1. \n ";
+            cout << "Incorrect input. Please enter 0, 1, 2 or 3. \n ";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
         }
     }
 
-    bool playerTwoType;
+    int playerTwoType;
     while(true){
-        cout << "Select AI type for player 2: 0 or 1? \n";
-        cin >> playerTwoType;
-        if(playerTwoType == 0 || playerTwoType == 1){
+        cout << "Select AI type for player 2: 0, 1, 2 or 3? \n";
+        if((cin >> playerTwoType) && playerTwoType >= 0 && playerTwoType <= 3){
             break; 
         }
         else {
-            cout << "Incorrect input. Please enter 0 or 1. \n ";
+            cout << "Incorrect input. Please enter 0, 1, 2 or 3. \n ";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+    }
+    // Number of threads used by the searching AIs
+    SearchLimits limits;
+    MctsLimits mctsLimits;
+    if (playerOneType >= 2 || playerTwoType >= 2) {
+        cout << "Select number of search threads (this computer has " << thread::hardware_concurrency() << " cores): \n";
+        while (!(cin >> limits.threads) || limits.threads < 1) {
+            cout << "Incorrect input. Please enter a positive number. \n";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+        mctsLimits.threads = limits.threads;
+
+        // A time per move is a hard deadline. Without one the search goes to a fixed depth
+        cout << "Select time per move in milliseconds, or 0 for no time limit: \n";
+        int moveTime;
+        while (!(cin >> moveTime) || moveTime < 0) {
+            cout << "Incorrect input. Please enter 0 or a positive number. \n";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+        if (moveTime > 0) {
+            limits.milliseconds = moveTime;
+            limits.depth = maxPly - 1;
+            mctsLimits.seconds = moveTime / 1000.0;
+        }
+    }
+
+    // Each MCTS AI keeps its own tree from move to move
+    unique_ptr<Mcts> mcts1, mcts2;
+    if (playerOneType == 3) mcts1 = make_unique<Mcts>();
+    if (playerTwoType == 3) mcts2 = make_unique<Mcts>();
+
+    // The search AIs may go on searching while the other player is thinking
+    unique_ptr<Ponderer> ponderer1, ponderer2;
+    if (playerOneType == 2 || playerTwoType == 2) {
+        cout << "Let the search AI think on the opponent's time? y or n \n";
+        char ponder;
+        cin >> ponder;
+        if (tolower(ponder) == 'y') {
+            if (playerOneType == 2) ponderer1 = make_unique<Ponderer>();
+            if (playerTwoType == 2) ponderer2 = make_unique<Ponderer>();
         }
     }
-    // 5. Play the game
+
+    // 5. Optionally record the game as a compressed game record
+    cout << "Enter a file name to record the game to, or n to skip: \n";
+    string recordFile;
+    cin >> recordFile;
+    unique_ptr<GameRecorder> recorder;
+    if (recordFile != "n") {
+        recorder = make_unique<GameRecorder>(cb);
+    }
+
+    // Tables made with tbgen.exe in the tablebases directory end the game as soon as they know the result
+    Tablebase tablebase("tablebases", maxTablebasePieces);
+    if (tablebase.size() > 0) {
+        limits.tablebase = &tablebase;
+    }
+
+    // A trained network replaces the handcrafted evaluation of the search
+    unique_ptr<Nnue> network;
+    if (ifstream("network.nnue")) {
+        network = make_unique<Nnue>("network.nnue");
+        limits.nnue = network.get();
+    }
+
+    // A book made with bookgen.exe is used for the first moves
+    unique_ptr<OpeningBook> book;
+    if (ifstream("book.lcb")) {
+        book = make_unique<OpeningBook>("book.lcb");
+    }
+
+    // 6. Play the game
     bool player1Colour = (startingColour == 'w') ? true : false;
     bool player2Colour = !player1Colour;
 
@@ -152,27 +262,51 @@ int main() {
 
     while(true){
         if(player1Turn){
-            bool player1Lose = (playerOneType == 1) ?  cb.smartAI(player1Colour) : cb.randomAI(player1Colour);
+            bool player1Lose = playAI(cb, playerOneType, player1Colour, limits, mctsLimits, book.get(), ponderer1.get(), mcts1.get());
 
             if(!player1Lose){
                 cout << "\n Player 1 won!\n";
+                if (recorder) GameWriter(recordFile).write(recorder->finish(player1Colour ? 1 : -1));
                 break;
             } else{
+                if (recorder) recorder->record(cb.getLastMove());
                 cout << "Player 1's turn: \n";
             }
             cout << cb;
             player1Turn = !player1Turn;
         } else{
-            bool player2Lose = (playerTwoType == 1) ?  cb.smartAI(player2Colour) : cb.randomAI(player2Colour);
+            bool player2Lose = playAI(cb, playerTwoType, player2Colour, limits, mctsLimits, book.get(), ponderer2.get(), mcts2.get());
             if(!player2Lose){
                 cout << "\n Player 2 won!\n";
+                if (recorder) GameWriter(recordFile).write(recorder->finish(player2Colour ? 1 : -1));
                 break;
             } else{
+              if (recorder) recorder->record(cb.getLastMove());
               cout << "Player 2's turn: \n";
 
             }
             cout << cb;
             player1Turn = !player1Turn;
         }
+
+        // Without captures or pawn moves for 50 moves each the game is a draw
+        if (cb.getHalfmoveClock() >= 100) {
+            cout << "\n Draw by the 50-move rule!\n";
+            if (recorder) GameWriter(recordFile).write(recorder->finish(0));
+            break;
+        }
+
+        TablebaseProbe probe;
+        if (tablebase.size() > 0 && tablebase.probe(cb, probe)) {
+            if (probe.result == tbDraw) {
+                cout << "\n Draw according to the tablebase!\n";
+                if (recorder) GameWriter(recordFile).write(recorder->finish(0));
+            } else {
+                bool whiteWins = (probe.result == tbWin) == cb.whiteToMove();
+                cout << "\n Player " << (whiteWins == player1Colour ? 1 : 2) << " wins in " << probe.distance << " plies according to the tablebase!\n";
+                if (recorder) GameWriter(recordFile).write(recorder->finish(whiteWins ? 1 : -1));
+            }
+            break;
+        }
     }    
 }
\ No newline at end of file
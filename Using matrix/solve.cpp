@@ -0,0 +1,58 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Position solver
+*/
+
+#include "ProofSolver.h"
+#include "EpdFile.h"
+#include <iostream>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o solve.exe solve.cpp ProofSolver.cpp EpdFile.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp MappedFile.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Random.cpp
+// Running:           ./solve.exe <seconds> <positions> [hash_mb]
+//
+// Reads a file with one FEN or EPD position per line and proves it a win or a loss for the side to move,
+// for example to adjudicate games or to find puzzles:
+//   win in 5 plies: a1a8 b8a8 ...
+// Positions that are not solved within the time, or are drawn, are reported as unknown.
+
+int main(int argc, char * argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <seconds> <positions> [hash_mb]" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        ProofLimits limits;
+        limits.seconds = stod(argv[1]);
+        limits.hash_mb = argc > 3 ? stoul(argv[3]) : limits.hash_mb;
+
+        EpdFile positions(argv[2]);
+        ChessBoard board;
+        FenPosition position;
+        while (positions.next(position)) {
+            board.setPosition(position);
+            ProofSolver solver(board);
+            ProofResult result = solver.solve(limits);
+
+            cout << writeFen(position) << "\n  ";
+            if (result.value == proofUnknown) {
+                cout << "unknown";
+            } else {
+                cout << (result.value == proofWin ? "win" : "loss") << " in " << result.line.size() << " plies:";
+                for (const ChessMove & move : result.line) {
+                    cout << " " << moveToString(move);
+                }
+            }
+            cout << "\n  " << result.nodes << " nodes in " << int(result.seconds * 1000) << " ms" << endl;
+        }
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,37 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Endgame tablebase generator
+*/
+
+#include "TablebaseGenerator.h"
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o tbgen.exe tbgen.cpp Tablebase.cpp TablebaseGenerator.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp MappedFile.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Random.cpp
+// Running:           ./tbgen.exe <directory> <max pieces> [threads]
+//
+// Tables go up to 4 pieces (maxTablebasePieces). The largest 4-piece tables take about 290 MB while they are built
+
+int main(int argc, char * argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <directory> <max pieces> [threads]" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        int maxPieces = stoi(argv[2]);
+        int threads = argc > 3 ? stoi(argv[3]) : static_cast<int>(thread::hardware_concurrency());
+        Tablebase tablebase;
+        generateTablebases(argv[1], maxPieces, threads, tablebase, cout);
+        cout << tablebase.size() << " tables up to " << maxPieces << " pieces in " << argv[1] << endl;
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
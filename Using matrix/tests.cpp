@@ -1,9 +1,36 @@
-// Compile: g++ -o tests.exe tests.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp
+// Compile: g++ -O2 -pthread -o tests.exe tests.cpp TablebaseGenerator.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp EpdFile.cpp PackedPosition.cpp MappedFile.cpp Search.cpp Mcts.cpp MoveOrdering.cpp ProofSolver.cpp TranspositionTable.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Tablebase.cpp Playout.cpp Random.cpp TrainingData.cpp Tuner.cpp Tournament.cpp GameRecord.cpp OpeningBook.cpp Ponder.cpp
 // Run tests: ./tests.exe < tests.in
 
 #include "ChessBoard.h"
+#include "ChessPiece.h"
+#include "EpdFile.h"
+#include "GameRecord.h"
+#include "MatrixIO.h"
+#include "Mcts.h"
+#include "OpeningBook.h"
+#include "PackedPosition.h"
+#include "Playout.h"
+#include "Random.h"
+#include "Ponder.h"
+#include "ProofSolver.h"
+#include "Search.h"
+#include "SparseMatrix.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "Tablebase.h"
+#include "TablebaseGenerator.h"
+#include "Tournament.h"
+#include "TrainingData.h"
+#include "Tuner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <sstream>
+#include <thread>
 
 using namespace std;
 
@@ -30,6 +57,22 @@ void testBoard(istream &is, int board_id) {
 
     board_ss >> board;
 
+    // The board must survive a FEN round trip unchanged
+    ChessBoard fen_board;
+    fen_board.setFen(board.getFen());
+    if (fen_board.getFen() != board.getFen()) {
+        throw runtime_error("Error: For board #" + to_string(board_id) + ", FEN round trip gave " +
+                            fen_board.getFen() + " (expected " + board.getFen() + ").");
+    }
+
+    // ... and through the packed binary format
+    ChessBoard packed_board;
+    unpackBoard(packBoard(board), packed_board);
+    if (packed_board.getFen() != board.getFen()) {
+        throw runtime_error("Error: For board #" + to_string(board_id) + ", packed round trip gave " +
+                            packed_board.getFen() + " (expected " + board.getFen() + ").");
+    }
+
     // Read expected values
     bool result = true;
     result &= !(is >> exp_white_cm).fail();
@@ -75,8 +118,816 @@ void testBoard(istream &is, int board_id) {
     }
 }
 
+// Throws if the call does not throw an exception of the given type
+template<typename Error, typename Call>
+void expectThrow(Call call, const string & message) {
+    try {
+        call();
+    } catch (Error &) {
+        return;
+    }
+    throw runtime_error("Error: " + message);
+}
+
+template<typename T>
+bool sameMatrix(const Matrix<T> & a, const Matrix<T> & b) {
+    return a.rows() == b.rows() && a.cols() == b.cols() && equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+// Parse and write known FEN/EPD records
+void testFen() {
+    const string start = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1";
+    ChessBoard board;
+    board.setFen(start);
+    if (board.getFen() != start || board.getWhitePieces().size() != 16 || board.nonCapturingMoves(true).size() != 20) {
+        throw runtime_error("Error: Starting position FEN was not read correctly.");
+    }
+
+    FenPosition position;
+    string epd = "8/8/8/3k4/8/8/8/4K3 b - - bm Kd4; id \"epd test\";";
+    if (!parseFen(epd, position) || position.white_to_move || string(position.operations, position.operations_length) != "bm Kd4; id \"epd test\";") {
+        throw runtime_error("Error: EPD record was not read correctly.");
+    }
+    if (parseFen("8/8/8/9/8/8/8/8 w - - 0 1", position)) {
+        throw runtime_error("Error: Malformed FEN was accepted.");
+    }
+    // Tabs, castling and en passant fields, or neither of them, before the counters
+    for (const string & fen : {"8/8/8/3k4/8/8/8/4K3\tb\t-\t-\t7\t31", "8/8/8/3k4/8/8/8/4K3 b KQkq e3 7 31", "8/8/8/3k4/8/8/8/4K3 b 7 31"}) {
+        if (!parseFen(fen, position) || position.white_to_move || position.halfmove_clock != 7 || position.fullmove_number != 31
+            || position.operations != nullptr) {
+            throw runtime_error("Error: FEN " + fen + " was not read correctly.");
+        }
+    }
+    if (!parseFen("8/8/8/3k4/8/8/8/4K3 w bm Kd4;", position) || string(position.operations, position.operations_length) != "bm Kd4;") {
+        throw runtime_error("Error: EPD record without castling and en passant fields was not read correctly.");
+    }
+    for (const string & fen : {"8/8/8/3k4/8/8/8/4K3 w - - -1 1", "8/8/8/3k4/8/8/8/4K3 w - - 0 -3", "8/8/8/3k4/8/8/8/4K3\tx - - 0 1"}) {
+        if (parseFen(fen, position)) {
+            throw runtime_error("Error: Malformed FEN " + fen + " was accepted.");
+        }
+    }
+
+    // A file with a comment, an empty line and a malformed record between two good ones
+    string path = (filesystem::temp_directory_path() / "losing-chess-test.epd").string();
+    {
+        ofstream file(path);
+        file << "# openings\n" << start << "\n\n" << "8/8/8/9/8/8/8/8 w - -\n" << epd;
+    }
+    {
+        EpdFile positions(path);
+        if (positions.size() != 3) {
+            throw runtime_error("Error: EPD file has the wrong number of records.");
+        }
+        positions.position(2, position);
+        if (string(position.operations, position.operations_length) != "bm Kd4; id \"epd test\";") {
+            throw runtime_error("Error: EPD record was not read from the file correctly.");
+        }
+        bool rejected = false;
+        try {
+            positions.position(1, position);
+        } catch (invalid_argument &) {
+            rejected = true;
+        }
+        size_t index;
+        if (!rejected || !positions.next(position, &index) || index != 0 || writeFen(position) != start) {
+            throw runtime_error("Error: Malformed EPD record was not reported.");
+        }
+    }
+    bool rejected = false;
+    try {
+        loadFens(path);
+    } catch (invalid_argument &) {
+        rejected = true;
+    }
+    filesystem::remove(path);
+    if (!rejected) {
+        throw runtime_error("Error: Openings with a malformed record were accepted.");
+    }
+}
+
+// Positions through a record file, corrupt positions, and games through the range coder and a game file
+void testRecords() {
+    vector<string> fens = {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1", "1n2k3/P1P5/8/3q4/4B3/8/5p2/4K1N1 b - - 37 1",
+                           "8/8/8/8/8/8/8/R6r w - - 127 1", "8/8/8/3k4/8/8/8/8 b - - 0 1"};
+    string path = (filesystem::temp_directory_path() / "losing-chess-test.pos").string();
+    {
+        PositionWriter writer(path);
+        FenPosition position;
+        for (const string & fen : fens) {
+            parseFen(fen, position);
+            PackedPosition packed;
+            packPosition(position, packed);
+            writer.write(packed);
+        }
+    }
+    {
+        PositionReader reader(path);
+        FenPosition position;
+        for (size_t i = 0; i < fens.size(); i++) {
+            unpackPosition(reader[i], position);
+            if (writeFen(position) != fens[i]) {
+                throw runtime_error("Error: Position " + fens[i] + " came back from the record file as " + writeFen(position) + ".");
+            }
+        }
+        if (reader.size() != fens.size()) {
+            throw runtime_error("Error: Position file has the wrong number of records.");
+        }
+        expectThrow<out_of_range>([&]() { reader[fens.size()]; }, "Position past the end of the file was read.");
+    }
+    filesystem::remove(path);
+
+    ChessBoard board;
+    board.setFen(fens[0]);
+    PackedPosition corrupt = packBoard(board);
+    FenPosition position;
+    for (uint8_t code : {6, 7, 14, 15}) {
+        corrupt.pieces[0] = static_cast<uint8_t>((corrupt.pieces[0] & 0xF0) | code);
+        expectThrow<invalid_argument>([&]() { unpackPosition(corrupt, position); }, "Corrupt piece code " + to_string(code) + " was accepted.");
+    }
+    corrupt = packBoard(board);
+    corrupt.occupancy = ~uint64_t(0);
+    expectThrow<invalid_argument>([&]() { unpackPosition(corrupt, position); }, "Position with 64 pieces was accepted.");
+
+    // Random games, with promotions close at hand in the second one
+    path = (filesystem::temp_directory_path() / "losing-chess-test.games").string();
+    vector<vector<string>> played;
+    vector<string> endings;
+    Xoshiro256 random(11);
+    {
+        GameWriter writer(path);
+        for (const string & start : {fens[0], string("4k3/P1P5/8/8/8/8/1p3p2/4K3 w - - 0 1")}) {
+            board.setFen(start);
+            GameRecorder recorder(board);
+            played.emplace_back();
+            for (int ply = 0; ply < 200; ply++) {
+                vector<ChessMove> moves = board.legalMoves(board.whiteToMove());
+                if (moves.empty()) break;
+                ChessMove move = moves[random.below(moves.size())];
+                played.back().push_back(moveToString(move));
+                board.makeMove(move);
+                recorder.record(move);
+            }
+            endings.push_back(board.getFen());
+            writer.write(recorder.finish(played.size() == 1 ? 1 : -1));
+        }
+    }
+    GameReader reader(path);
+    GameRecord record;
+    for (size_t game = 0; game < played.size(); game++) {
+        if (!reader.next(record) || record.nr_moves != played[game].size() || record.result != (game == 0 ? 1 : -1)) {
+            throw runtime_error("Error: Game record was not read back.");
+        }
+        vector<string> replayed;
+        replayGame(record, board, [&](ChessBoard &, const ChessMove & move) { replayed.push_back(moveToString(move)); });
+        if (replayed != played[game] || board.getFen().substr(0, board.getFen().rfind(' ')) != endings[game].substr(0, endings[game].rfind(' '))) {
+            throw runtime_error("Error: Game record does not replay the game.");
+        }
+    }
+    if (reader.next(record)) {
+        throw runtime_error("Error: Game file has more records than were written.");
+    }
+    filesystem::remove(path);
+}
+
+void testSolver() {
+    // White must take the rook on a8 and black must take back, leaving white without pieces
+    ChessBoard board;
+    board.setFen("rr6/8/8/8/8/8/8/R7 w - - 0 1");
+    ProofResult result = ProofSolver(board).solve(ProofLimits());
+    if (result.value != proofWin || result.line.size() != 2 || board.getFen() != "rr6/8/8/8/8/8/8/R7 w - - 0 1") {
+        throw runtime_error("Error: Forced win was not proved.");
+    }
+
+    // Taking the only black piece makes black the winner
+    board.setFen("r7/8/8/8/8/8/8/R7 w - - 0 1");
+    if (ProofSolver(board).solve(ProofLimits()).value != proofLoss) {
+        throw runtime_error("Error: Forced loss was not proved.");
+    }
+}
+
+// Conversion between dense and sparse storage, the sparse times dense product and the text format
+void testSparseMatrix() {
+    Matrix<int> dense(3, 4);
+    dense(0, 1) = 2;
+    dense(1, 3) = -1;
+    dense(2, 0) = 5;
+    dense(2, 3) = 3;
+    SparseMatrix<int> sparse(dense);
+    if (sparse.nonZeros() != 4 || sparse.rowBegin(2) != 2 || sparse.columnOf(3) != 3 || sparse.contains(1, 2)) {
+        throw runtime_error("Error: Sparse matrix was not built from the dense one.");
+    }
+    Matrix<int> back = sparse.toDense();
+    if (!equal(back.begin(), back.end(), dense.begin(), dense.end())) {
+        throw runtime_error("Error: Sparse matrix does not convert back to the dense one.");
+    }
+
+    Matrix<int> other(4, 2);
+    for (size_t i = 0; i < 4; i++) {
+        other(i, 0) = int(i) + 1;
+        other(i, 1) = 2 - int(i);
+    }
+    Matrix<int> product = sparse * other;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 2; j++) {
+            int expected = 0;
+            for (size_t k = 0; k < 4; k++) expected += dense(i, k) * other(k, j);
+            if (product(i, j) != expected) {
+                throw runtime_error("Error: Sparse times dense product is wrong.");
+            }
+        }
+    }
+
+    stringstream stream;
+    stream << sparse;
+    SparseMatrix<int> read;
+    stream >> read;
+    Matrix<int> readBack = read.toDense();
+    if (read.rows() != 3 || read.cols() != 4 || read.nonZeros() != 4 || !equal(readBack.begin(), readBack.end(), dense.begin(), dense.end())) {
+        throw runtime_error("Error: Sparse matrix did not survive writing and reading.");
+    }
+    for (const string & text : {"[ 1 0 2\n  0 3 ]", "[ 1 0\n  0 3 4 ]"}) {
+        stringstream ragged(text);
+        expectThrow<out_of_range>([&]() { ragged >> read; }, "Sparse matrix with rows of different lengths was read.");
+    }
+}
+
+// Text and binary round trips through buffers, streams and files, and the inputs they must reject
+void testMatrixIO() {
+    Matrix<int> m(3, 4);
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 4; j++) m(i, j) = int(i * 4 + j) * (j % 2 == 0 ? 1 : -37);
+    }
+
+    string text;
+    writeMatrix(text, m);
+    ostringstream streamText;
+    streamText << m;
+    ostringstream blockText;
+    writeMatrix(blockText, m);
+    Matrix<int> back;
+    parseMatrix(text.data(), text.data() + text.size(), back);
+    if (!sameMatrix(back, m) || text != streamText.str() || text != blockText.str()) {
+        throw runtime_error("Error: Text matrix does not round-trip.");
+    }
+    string ragged = "1 2 3\n4 5\n";
+    expectThrow<out_of_range>([&]() { parseMatrix(ragged.data(), ragged.data() + ragged.size(), back); }, "Short matrix row was accepted.");
+    string garbage = "1 2\n3 x\n";
+    expectThrow<invalid_argument>([&]() { parseMatrix(garbage.data(), garbage.data() + garbage.size(), back); }, "Invalid matrix element was accepted.");
+
+    ostringstream binaryStream;
+    saveBinary(binaryStream, m);
+    string binary = binaryStream.str();
+    if (binary.size() != sizeof(MatrixFileHeader) + 12 * sizeof(int)) {
+        throw runtime_error("Error: Binary matrix has the wrong size.");
+    }
+    Matrix<int> fromBuffer;
+    loadBinary(binary.data(), binary.size(), fromBuffer);
+    istringstream binaryInput(binary);
+    Matrix<int> fromStream;
+    loadBinary(binaryInput, fromStream);
+    if (!sameMatrix(fromBuffer, m) || !sameMatrix(fromStream, m)) {
+        throw runtime_error("Error: Binary matrix does not round-trip.");
+    }
+
+    string truncated = binary.substr(0, binary.size() - 1);
+    expectThrow<out_of_range>([&]() { loadBinary(truncated.data(), truncated.size(), back); }, "Truncated binary matrix was accepted.");
+    expectThrow<out_of_range>([&]() { istringstream in(truncated); loadBinary(in, back); }, "Truncated binary matrix stream was accepted.");
+    string header = binary.substr(0, sizeof(MatrixFileHeader) - 1);
+    expectThrow<invalid_argument>([&]() { loadBinary(header.data(), header.size(), back); }, "Binary matrix without header was accepted.");
+    string badMagic = binary;
+    badMagic[3] = '2';
+    expectThrow<invalid_argument>([&]() { loadBinary(badMagic.data(), badMagic.size(), back); }, "Binary matrix with a bad magic was accepted.");
+    expectThrow<invalid_argument>([&]() { istringstream in(badMagic); loadBinary(in, back); }, "Binary matrix stream with a bad magic was accepted.");
+    // Headers whose size overflows or is more than the data there is, checked before allocating
+    for (uint64_t rows : {uint64_t(1) << 62, uint64_t(1) << 40}) {
+        string huge = binary;
+        MatrixFileHeader hugeHeader;
+        memcpy(&hugeHeader, huge.data(), sizeof(hugeHeader));
+        hugeHeader.rows = rows;
+        hugeHeader.cols = rows >> 38;
+        memcpy(&huge[0], &hugeHeader, sizeof(hugeHeader));
+        expectThrow<out_of_range>([&]() { loadBinary(huge.data(), huge.size(), back); }, "Binary matrix with a huge header was accepted.");
+        expectThrow<out_of_range>([&]() { istringstream in(huge); loadBinary(in, back); }, "Binary matrix stream with a huge header was accepted.");
+    }
+    Matrix<double> wrongType;
+    expectThrow<invalid_argument>([&]() { loadBinary(binary.data(), binary.size(), wrongType); }, "Binary matrix of another element size was accepted.");
+    expectThrow<invalid_argument>([&]() { istringstream in(binary); loadBinary(in, wrongType); }, "Binary matrix stream of another element size was accepted.");
+
+    filesystem::path directory = filesystem::temp_directory_path();
+    string textPath = (directory / "losing-chess-matrix.txt").string();
+    string binaryPath = (directory / "losing-chess-matrix.mtx").string();
+    ofstream(textPath) << text;
+    ofstream(binaryPath, ios::binary) << binary;
+    Matrix<int> fromTextFile;
+    Matrix<int> fromBinaryFile;
+    loadTextFile(textPath, fromTextFile);
+    loadBinaryFile(binaryPath, fromBinaryFile);
+    filesystem::remove(textPath);
+    filesystem::remove(binaryPath);
+    if (!sameMatrix(fromTextFile, m) || !sameMatrix(fromBinaryFile, m)) {
+        throw runtime_error("Error: Matrix files do not round-trip.");
+    }
+}
+
+// The search finds a quick forced win and gives several lines in order
+void testSearch() {
+    // Only a1h1 and a1a8 make black take the last white piece, which wins in 2 plies
+    ChessBoard board;
+    board.setFen("7r/8/8/8/8/8/8/R7 w - - 0 1");
+    TranspositionTable tt(1);
+    SearchLimits limits;
+    limits.depth = 4;
+    SearchResult result = Search(board, tt).think(limits);
+    string move = moveToString(result.best_move);
+    if (!result.has_move || (move != "a1h1" && move != "a1a8") || result.score != winScore - 2) {
+        throw runtime_error("Error: Search did not find the win in 2 plies.");
+    }
+
+    board.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1");
+    tt.clear();
+    limits.multi_pv = 3;
+    result = Search(board, tt).think(limits);
+    vector<string> legal;
+    for (const ChessMove & legalMove : board.legalMoves(true)) {
+        legal.push_back(moveToString(legalMove));
+    }
+    if (result.lines.size() != 3) {
+        throw runtime_error("Error: Search did not return 3 lines.");
+    }
+    for (size_t i = 0; i < 3; i++) {
+        string first = moveToString(result.lines[i].moves[0]);
+        if (find(legal.begin(), legal.end(), first) == legal.end()
+            || (i > 0 && (first == moveToString(result.lines[i - 1].moves[0]) || first == moveToString(result.lines[0].moves[0])
+                          || result.lines[i].score > result.lines[i - 1].score))) {
+            throw runtime_error("Error: Search lines are not distinct legal moves in order of their scores.");
+        }
+    }
+
+    // The counters add up, with one info line and one iteration for every completed depth
+    tt.clear();
+    limits.multi_pv = 1;
+    limits.depth = 5;
+    stringstream info;
+    limits.info = &info;
+    result = Search(board, tt).think(limits);
+    const SearchStats & stats = result.stats;
+    if (stats.nodes != result.nodes || stats.nodes < stats.quiescence_nodes || stats.tt_hits > stats.tt_probes
+        || stats.first_move_cutoffs > stats.cutoffs || stats.iterations.size() != size_t(result.depth) || result.depth != 5) {
+        throw runtime_error("Error: Search counters do not add up.");
+    }
+    for (size_t i = 0; i < stats.iterations.size(); i++) {
+        if (stats.iterations[i].depth != int(i) + 1 || (i > 0 && stats.iterations[i].nodes < stats.iterations[i - 1].nodes)) {
+            throw runtime_error("Error: Search iterations are not one per depth.");
+        }
+    }
+    if (stats.branchingFactor() <= 0 || stats.iterations.back().score != result.score) {
+        throw runtime_error("Error: Search iterations do not match the result.");
+    }
+    vector<string> infoLines;
+    for (string line; getline(info, line);) {
+        infoLines.push_back(line);
+    }
+    if (infoLines.size() != stats.iterations.size() || infoLines.back().rfind("info depth 5 score " + to_string(result.score) + " nodes ", 0) != 0
+        || stats.infoLine(1, 0).rfind("info depth 5 ", 0) != 0) {
+        throw runtime_error("Error: Search info lines were not written for every iteration.");
+    }
+    string json = stats.json(1, 0);
+    if (json.rfind("{\"nodes\":" + to_string(stats.nodes) + ",", 0) != 0 || json.find("{\"depth\":5,") == string::npos || json.back() != '}') {
+        throw runtime_error("Error: Search statistics were not written as JSON.");
+    }
+}
+
+// Playouts repeat from the same seed, and the tree search keeps the part of its tree below the move played
+void testMcts() {
+    const string start = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1";
+    ChessBoard board;
+    board.setFen(start);
+    Playout first(7), second(7);
+    for (int game = 0; game < 20; game++) {
+        PlayoutResult a = first.play(board);
+        PlayoutResult b = second.play(board);
+        if (a.result != b.result || a.plies != b.plies) {
+            throw runtime_error("Error: Playouts from the same seed differ in game " + to_string(game) + ".");
+        }
+    }
+    if (board.getFen() != start) {
+        throw runtime_error("Error: Playouts changed the board.");
+    }
+    PlayoutStats stats = runPlayouts(board, 200, 1, 42);
+    if (stats.games != 200 || runPlayouts(board, 200, 1, 42).plies != stats.plies || runPlayouts(board, 200, 1, 43).plies == stats.plies) {
+        throw runtime_error("Error: Playouts on one thread are not repeated from the seed.");
+    }
+
+    Mcts mcts;
+    MctsLimits limits;
+    limits.seconds = 60;
+    limits.playouts = 2000;
+    MctsResult result = mcts.think(board, limits);
+    if (!result.has_move || result.reused != 0 || result.playouts < limits.playouts) {
+        throw runtime_error("Error: Tree search from the start position did not search a new tree.");
+    }
+    board.makeMove(result.best_move);
+    result = mcts.think(board, limits);
+    if (!result.has_move || result.reused == 0) {
+        throw runtime_error("Error: Tree search did not keep its tree after the move it played.");
+    }
+    board.makeMove(result.best_move);
+    board.makeMove(board.legalMoves(board.whiteToMove())[0]);
+    if (mcts.think(board, limits).reused == 0) {
+        throw runtime_error("Error: Tree search did not keep its tree after a move and the reply.");
+    }
+    board.setFen("8/8/8/3k4/8/8/8/R6r w - - 0 1");
+    if (mcts.think(board, limits).reused != 0) {
+        throw runtime_error("Error: Tree search kept a tree from another game.");
+    }
+}
+
+// Black has to take the knight, so that is the reply to ponder on. A hit gives the search of the answer,
+// a miss stops it even when it has no depth limit
+void testPonder() {
+    ChessBoard board;
+    board.setFen("r1bqkbnr/pppppppp/N7/8/8/8/PPPPPPPP/R1BQKBNR b - - 0 1");
+    SearchLimits limits;
+    limits.depth = 3;
+    Ponderer ponderer;
+    if (!ponderer.start(board, limits) || !ponderer.pondering() || moveToString(ponderer.expected()) != "b7a6") {
+        throw runtime_error("Error: Pondering did not start on the only reply.");
+    }
+    ChessMove reply = board.legalMoves(false)[0];
+    board.makeMove(reply);
+    SearchResult result;
+    if (!ponderer.finish(reply, limits, result) || !result.has_move || result.depth != 3 || ponderer.pondering()) {
+        throw runtime_error("Error: Ponder hit did not return the search.");
+    }
+
+    board.setFen("r1bqkbnr/pppppppp/N7/8/8/8/PPPPPPPP/R1BQKBNR b - - 0 1");
+    limits.depth = maxPly - 1;
+    if (!ponderer.start(board, limits) || ponderer.finish(ChessMove{1, 1, 2, 1, nullptr}, limits, result) || ponderer.pondering()) {
+        throw runtime_error("Error: Ponder miss did not stop the search.");
+    }
+}
+
+// The incremental piece-square score must match a full recount after every move and take-back
+void testEvaluation() {
+    ChessBoard board;
+    board.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1");
+    if (board.getPsqScore() != 0) {
+        throw runtime_error("Error: Symmetric position does not evaluate to 0.");
+    }
+
+    board.setFen("1n2k3/P1P5/8/3q4/4B3/8/5p2/4K1N1 w - - 0 1");
+    int before = board.getPsqScore();
+    for (bool is_white : {true, false}) {
+        board.setWhiteToMove(is_white);
+        for (const ChessMove & move : board.legalMoves(is_white)) {
+            UndoInfo undo = board.makeMove(move);
+            if (board.getPsqScore() != computePieceSquareScore(board)) {
+                throw runtime_error("Error: Piece-square score was not updated by a move.");
+            }
+            board.unmakeMove(undo);
+        }
+    }
+    board.setWhiteToMove(true);
+    if (board.getPsqScore() != before || before != computePieceSquareScore(board)) {
+        throw runtime_error("Error: Piece-square score was not restored by unmakeMove.");
+    }
+
+    // The tuner's features times the weights give the evaluation seen from white
+    vector<double> weights = evalWeights(evalParams());
+    vector<ChessMove> moves;
+    for (const string & fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1", "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b - - 0 1",
+                               "1n2k3/P1P5/8/3q4/4B3/8/5p2/4K1N1 w - - 0 1", "1n2k3/P1P5/8/3q4/4B3/8/5p2/4K1N1 b - - 0 1", "8/8/8/8/8/8/8/R6r b - - 0 1"}) {
+        board.setFen(fen);
+        int counts[nrEvalWeights] = {};
+        countEvalFeatures(board, moves, counts);
+        double dot = 0;
+        for (int i = 0; i < nrEvalWeights; i++) dot += weights[i] * counts[i];
+        int expected = evaluatePosition(board, static_cast<int>(moves.size()));
+        if (dot != (board.whiteToMove() ? expected : -expected)) {
+            throw runtime_error("Error: Tuner features do not match the evaluation of " + fen + ".");
+        }
+    }
+
+    // Weights round-trip through the flat list the tuner works on
+    EvalParams params = evalParams();
+    params.material[2] = -123;
+    params.psq[5][63] = 77;
+    params.mobility = 9;
+    params.tempo = -4;
+    EvalParams back = evalParamsFrom(evalWeights(params));
+    if (evalWeights(params).size() != size_t(nrEvalWeights) || memcmp(back.material, params.material, sizeof(params.material)) != 0
+        || memcmp(back.psq, params.psq, sizeof(params.psq)) != 0 || back.mobility != params.mobility || back.tempo != params.tempo) {
+        throw runtime_error("Error: Evaluation weights do not round-trip.");
+    }
+}
+
+// The accumulator follows the board through moves and take-backs, and both versions of the network agree
+void testNetwork() {
+    Nnue network;
+    network.randomize(1);
+    NnueAccumulator accumulator;
+    accumulator.weights = &network.weights();
+    ChessBoard board;
+    board.setFen("1n2k3/P1P5/8/3q4/4B3/8/5p2/4K1N1 w - - 0 1");
+    board.setAccumulator(&accumulator);
+
+    for (const ChessMove & move : board.legalMoves(true)) {
+        UndoInfo undo = board.makeMove(move);
+        NnueAccumulator fresh;
+        fresh.weights = accumulator.weights;
+        ChessBoard copy(board);
+        copy.setAccumulator(&fresh);
+        if (memcmp(fresh.values, accumulator.values, sizeof(fresh.values)) != 0) {
+            throw runtime_error("Error: Network accumulator was not updated by a move.");
+        }
+        if (network.evaluate(accumulator, false) != network.evaluateScalar(accumulator, false)) {
+            throw runtime_error("Error: Vectorized network evaluation differs from the scalar one.");
+        }
+        board.unmakeMove(undo);
+    }
+    board.setAccumulator(nullptr);
+}
+
+// Pieces of the board, or with flipped the colours swapped and the board turned upside down
+static vector<TablebasePiece> tablebasePieces(ChessBoard & board, bool flipped) {
+    vector<TablebasePiece> pieces;
+    for (auto * side : {&board.getWhitePieces(), &board.getBlackPieces()}) {
+        for (ChessPiece * piece : *side) {
+            char c = piece->getLatin1Representation();
+            if (flipped) {
+                pieces.push_back({static_cast<char>(isupper(c) ? tolower(c) : toupper(c)), 7 - piece->getX(), piece->getY()});
+            } else {
+                pieces.push_back({c, piece->getX(), piece->getY()});
+            }
+        }
+    }
+    return pieces;
+}
+
+// Tables of up to 3 pieces, checked against the positions after every move and with the colours swapped
+// Threads writing at the same time fill every shard but the last to exactly its size, and no sample is lost
+// The SPRT and the error bars against values worked out by hand
+void testTournament() {
+    auto near = [](double a, double b) { return fabs(a - b) < 1e-9; };
+    SprtOptions sprt;
+    if (!near(sprt.lowerBound(), -2.9444389791664403) || !near(sprt.upperBound(), 2.9444389791664403)) {
+        throw runtime_error("Error: SPRT bounds are wrong for alpha = beta = 0.05.");
+    }
+    sprt.alpha = 0.05;
+    sprt.beta = 0.1;
+    if (!near(sprt.lowerBound(), -2.251291798606495) || !near(sprt.upperBound(), 2.8903717578961645)) {
+        throw runtime_error("Error: SPRT bounds are wrong for alpha = 0.05 and beta = 0.1.");
+    }
+
+    uint64_t none[5] = {};
+    uint64_t even[5] = {10, 20, 40, 20, 10};
+    uint64_t better[5] = {5, 15, 40, 30, 10};
+    uint64_t onePair[5] = {0, 0, 0, 0, 1};
+    if (sprtLlr(none, 0, 10) != 0 || !near(sprtLlr(even, 0, 10), -0.1357861407564948) || !near(sprtLlr(better, 0, 10), 1.2558952912546162)
+        || !near(sprtLlr(onePair, 0, 10), 0.026469693782508383)) {
+        throw runtime_error("Error: SPRT log-likelihood ratio is wrong.");
+    }
+
+    // All games in pairs uses the pentanomial, an odd game out the wins, losses and draws
+    TournamentResult result;
+    result.wins = 35;
+    result.losses = 35;
+    result.draws = 30;
+    copy(begin(even), end(even), result.pentanomial);
+    for (uint64_t & pairs : result.pentanomial) pairs /= 2;
+    if (!near(result.eloError(), 54.00961766663237) || result.elo() != 0) {
+        throw runtime_error("Error: Elo error bar from pairs is wrong.");
+    }
+    result.wins = 30;
+    result.losses = 20;
+    result.draws = 51;
+    if (!near(result.eloError(), 47.97992250738042)) {
+        throw runtime_error("Error: Elo error bar from single games is wrong.");
+    }
+    result.losses = 0;
+    result.draws = 0;
+    if (!isinf(result.elo()) || result.elo() < 0) {
+        throw runtime_error("Error: Elo of a clean sweep is not infinite.");
+    }
+    swap(result.wins, result.losses);
+    if (!isinf(result.elo()) || result.elo() > 0) {
+        throw runtime_error("Error: Elo of a whitewash is not minus infinite.");
+    }
+
+    EngineSpec spec = parseEngine("search:6:250");
+    if (spec.type != engineSearch || spec.search.depth != 6 || spec.search.milliseconds != 250 || spec.name != "search:6:250"
+        || parseEngine("search:3").search.milliseconds != 0 || parseEngine("mcts:500").mcts.playouts != 500
+        || parseEngine("random").type != engineRandom || parseEngine("smart").type != engineSmart) {
+        throw runtime_error("Error: Engine was not parsed correctly.");
+    }
+    for (const char * bad : {"", "minimax", "random:1", "smart:", "search", "search:0", "search:x", "search:4:-1", "search:4:1:2",
+                             "search:128", "mcts", "mcts:0", "mcts:1:2"}) {
+        expectThrow<invalid_argument>([&]() { parseEngine(bad); }, string("Engine ") + bad + " was accepted.");
+    }
+}
+
+void testTrainingData() {
+    filesystem::path directory = filesystem::temp_directory_path() / "losing-chess-training-test";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    const size_t shardSize = 10;
+    const int threads = 4;
+    const int batches = 50;
+    const int batchSize = 7;
+    {
+        ShardWriter writer((directory / "test").string(), shardSize);
+        vector<thread> producers;
+        for (int t = 0; t < threads; t++) {
+            producers.emplace_back([&writer, t]() {
+                vector<TrainingSample> batch(batchSize);
+                for (int i = 0; i < batches; i++) {
+                    for (int j = 0; j < batchSize; j++) {
+                        batch[j] = TrainingSample();
+                        batch[j].ply = uint16_t((t * batches + i) * batchSize + j);
+                    }
+                    writer.write(batch);
+                }
+            });
+        }
+        for (thread & producer : producers) {
+            producer.join();
+        }
+        writer.finish();
+    }
+
+    vector<string> shards = readShardIndex((directory / "test.index").string());
+    vector<bool> seen(threads * batches * batchSize);
+    size_t total = 0;
+    for (size_t i = 0; i < shards.size(); i++) {
+        ShardReader shard(shards[i]);
+        if ((i + 1 < shards.size() && shard.size() != shardSize) || shard.size() == 0 || shard.size() > shardSize) {
+            throw runtime_error("Error: Training data shard " + to_string(i) + " has " + to_string(shard.size()) + " samples.");
+        }
+        for (size_t j = 0; j < shard.size(); j++) {
+            if (shard[j].ply >= seen.size() || seen[shard[j].ply]) {
+                throw runtime_error("Error: Training data sample was written twice.");
+            }
+            seen[shard[j].ply] = true;
+        }
+        total += shard.size();
+    }
+    filesystem::remove_all(directory);
+    if (total != seen.size()) {
+        throw runtime_error("Error: Training data samples were lost.");
+    }
+}
+
+// A book built from several sorted runs holds the counts of every move played from the start position
+void testOpeningBook() {
+    string path = (filesystem::temp_directory_path() / "losing-chess-test.book").string();
+    string gamesPath = path + ".games";
+    const int nrGames = 300;
+    const int plies = 12;
+    map<uint16_t, BookEntry> expected;
+    ChessBoard board;
+    Xoshiro256 random(7);
+    {
+        GameWriter writer(gamesPath);
+        for (int game = 0; game < nrGames; game++) {
+            board.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1");
+            GameRecorder recorder(board);
+            int result = game % 3 - 1;
+            for (int ply = 0; ply < plies; ply++) {
+                vector<ChessMove> moves = board.legalMoves(board.whiteToMove());
+                if (moves.empty()) break;
+                ChessMove move = moves[random.below(moves.size())];
+                if (ply == 0) {
+                    BookEntry & entry = expected[packMove(move)];
+                    entry.games++;
+                    entry.wins += result > 0;
+                    entry.draws += result == 0;
+                }
+                board.makeMove(move);
+                recorder.record(move);
+            }
+            writer.write(recorder.finish(result));
+        }
+    }
+
+    size_t entries;
+    {
+        BookBuilder builder(path, plies, 0);     // the smallest budget, 1024 entries per run
+        builder.addGameFile(gamesPath);
+        if (!filesystem::exists(path + ".run2")) {
+            throw runtime_error("Error: Book builder did not write several runs.");
+        }
+        entries = builder.finish();
+    }
+    filesystem::remove(gamesPath);
+
+    board.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1");
+    OpeningBook book(path);
+    auto [first, last] = book.probe(board.getHash());
+    size_t found = last - first;
+    bool same = book.size() == entries && found == expected.size() && !filesystem::exists(path + ".run0");
+    for (const BookEntry * entry = first; same && entry != last; entry++) {
+        const BookEntry & count = expected[entry->move];
+        same = entry->games == count.games && entry->wins == count.wins && entry->draws == count.draws;
+    }
+    ChessMove picked;
+    same = same && book.pickMove(board, random, picked) && expected.count(packMove(picked)) == 1;
+    book = OpeningBook();
+    filesystem::remove(path);
+    if (!same) {
+        throw runtime_error("Error: Opening book does not hold the counts of the games.");
+    }
+}
+
+void testTablebase() {
+    filesystem::path directory = filesystem::temp_directory_path() / "losing-chess-tablebase-test";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+    Tablebase tablebase;
+    ostringstream log;
+    generateTablebases(directory.string(), 3, thread::hardware_concurrency(), tablebase, log);
+    expectThrow<invalid_argument>([&]() { generateTablebases(directory.string(), maxTablebasePieces + 1, 1, tablebase, log); },
+                                  "Tablebases above the supported number of pieces were generated.");
+    filesystem::remove_all(directory);
+
+    ChessBoard board;
+    vector<ChessMove> moves;
+    for (const TablebaseMaterial & material : tablebaseMaterials(3)) {
+        size_t step = material.size() / 1000 + 1;    // about a thousand positions of each table
+        for (size_t index = 0; index < material.size(); index += step) {
+            FenPosition position;
+            if (!tablebasePosition(material, index, position)) continue;
+            board.setPosition(position);
+
+            // Several indices can describe the same position, e.g. with two alike pieces. The index
+            // of the position must lead back to it, up to symmetry
+            TablebaseMaterial indexMaterial;
+            size_t positionIndex;
+            tablebaseIndex(tablebasePieces(board, false), board.whiteToMove(), indexMaterial, positionIndex);
+            FenPosition canonical;
+            size_t canonicalIndex = 0;
+            ChessBoard canonicalBoard;
+            if (indexMaterial.name() == material.name() && tablebasePosition(material, positionIndex, canonical)) {
+                canonicalBoard.setPosition(canonical);
+                tablebaseIndex(tablebasePieces(canonicalBoard, false), canonicalBoard.whiteToMove(), indexMaterial, canonicalIndex);
+            }
+            if (indexMaterial.name() != material.name() || canonicalIndex != positionIndex) {
+                throw runtime_error("Error: Tablebase index of " + board.getFen() + " does not lead back to the position.");
+            }
+
+            // Won if a move reaches a lost position, lost if all moves reach won positions
+            TablebaseProbe probe, child, flipped;
+            TablebaseProbe expected;
+            expected.result = tbWin;
+            board.generateMoves(board.whiteToMove(), moves);
+            bool allWon = true;
+            int bestLoss = -1;
+            int longestWin = 0;
+            for (const ChessMove & move : vector<ChessMove>(moves)) {
+                UndoInfo undo = board.makeMove(move);
+                if (!tablebase.probe(board, child)) {
+                    throw runtime_error("Error: No tablebase entry after a move from " + writeFen(position) + ".");
+                }
+                board.unmakeMove(undo);
+                if (child.result == tbLoss && (bestLoss < 0 || child.distance < bestLoss)) bestLoss = child.distance;
+                if (child.result == tbWin) longestWin = max(longestWin, child.distance);
+                allWon = allWon && child.result == tbWin;
+            }
+            if (bestLoss >= 0) {
+                expected.distance = bestLoss + 1;
+            } else if (!moves.empty() && allWon) {
+                expected.result = tbLoss;
+                expected.distance = longestWin + 1;
+            } else if (!moves.empty()) {
+                expected.result = tbDraw;
+            }
+
+            if (!tablebase.probe(board, probe) || probe.result != expected.result || (probe.result != tbDraw && probe.distance != expected.distance)) {
+                throw runtime_error("Error: Tablebase entry of " + board.getFen() + " does not follow from its moves.");
+            }
+            if (!tablebase.probe(tablebasePieces(board, true), !board.whiteToMove(), flipped) || flipped.result != probe.result || flipped.distance != probe.distance) {
+                throw runtime_error("Error: Tablebase entry of " + board.getFen() + " changes when the colours are swapped.");
+            }
+        }
+    }
+}
+
 int main() {
     try {
+        testFen();
+        testRecords();
+        testSolver();
+        testSparseMatrix();
+        testMatrixIO();
+        testSearch();
+        testPonder();
+        testMcts();
+        testEvaluation();
+        testNetwork();
+        testTournament();
+        testTrainingData();
+        testOpeningBook();
+        testTablebase();
+
         // Test boards from stdin
         int board_id = 1;
         while (!cin.eof()) {
@@ -0,0 +1,91 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Engine tournament
+*/
+
+#include "Tournament.h"
+#include "EpdFile.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "Tablebase.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o tournament.exe tournament.cpp Tournament.cpp EpdFile.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp MappedFile.cpp Search.cpp Mcts.cpp MoveOrdering.cpp TranspositionTable.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Tablebase.cpp Playout.cpp Random.cpp
+// Running:           ./tournament.exe <engine1> <engine2> <games> [threads] [openings] [elo0 elo1 [alpha beta]]
+//
+// Engines are random, smart, search:<depth>, search:<depth>:<milliseconds> or mcts:<playouts>.
+// For example ./tournament.exe search:4 smart 1000 plays 500 pairs of games.
+// The openings file has one FEN or EPD position per line, - for none.
+// With Elo bounds the games stop as soon as an SPRT decides whether engine1 is elo0 or elo1
+// stronger than engine2, for example ./tournament.exe search:5 search:4 20000 8 - 0 10
+
+int main(int argc, char * argv[]) {
+    if (argc < 4 || argc == 7) { // elo0 without elo1
+        cerr << "Usage: " << argv[0] << " <engine1> <engine2> <games> [threads] [openings] [elo0 elo1 [alpha beta]]" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        EngineSpec first = parseEngine(argv[1]);
+        EngineSpec second = parseEngine(argv[2]);
+        TournamentOptions options;
+        options.games = stoull(argv[3]);
+        options.threads = argc > 4 ? stoi(argv[4]) : static_cast<int>(thread::hardware_concurrency());
+        if (argc > 5 && string(argv[5]) != "-") {
+            options.openings = loadFens(argv[5]);
+        }
+        if (argc > 7) {
+            options.sprt.enabled = true;
+            options.sprt.elo0 = stod(argv[6]);
+            options.sprt.elo1 = stod(argv[7]);
+            options.sprt.alpha = argc > 8 ? stod(argv[8]) : options.sprt.alpha;
+            options.sprt.beta = argc > 9 ? stod(argv[9]) : options.sprt.beta;
+            if (options.sprt.elo1 <= options.sprt.elo0 || options.sprt.alpha <= 0 || options.sprt.alpha >= 1
+                || options.sprt.beta <= 0 || options.sprt.beta >= 1) {
+                throw invalid_argument("The SPRT needs elo0 < elo1 and alpha and beta between 0 and 1!");
+            }
+        }
+
+        // The same weights, tables and network as main.cpp, if they are there
+        if (ifstream("evaluation.txt")) {
+            setEvalParams(loadEvalParams("evaluation.txt"));
+        }
+        Tablebase tablebase("tablebases", maxTablebasePieces);
+        if (tablebase.size() > 0) options.tablebase = &tablebase;
+        unique_ptr<Nnue> network;
+        if (ifstream("network.nnue")) {
+            network = make_unique<Nnue>("network.nnue");
+            first.search.nnue = network.get();
+            second.search.nnue = network.get();
+        }
+
+        TournamentResult result = runTournament(first, second, options, cout);
+        cout << first.name << " vs " << second.name << ": " << result.wins << " wins, " << result.losses << " losses, "
+             << result.draws << " draws, score " << result.score() * 100 << "%, Elo " << result.elo();
+        if (isfinite(result.elo())) { // no error bar for a clean sweep
+            cout << " +- " << result.eloError();
+        }
+        cout << " (" << result.games() / max(result.seconds, 1e-9) << " games/s)" << endl;
+        const uint64_t * pairs = result.pentanomial;
+        cout << "Pairs by points of " << first.name << " (0, 0.5, 1, 1.5, 2): " << pairs[0] << ", " << pairs[1] << ", " << pairs[2]
+             << ", " << pairs[3] << ", " << pairs[4] << endl;
+        if (options.sprt.enabled) {
+            cout << "SPRT [" << options.sprt.elo0 << ", " << options.sprt.elo1 << "]: LLR " << result.llr << " ("
+                 << options.sprt.lowerBound() << ", " << options.sprt.upperBound() << "), "
+                 << (result.sprt > 0 ? "H1 accepted" : result.sprt < 0 ? "H0 accepted" : "no decision") << endl;
+        }
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
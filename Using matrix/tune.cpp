@@ -0,0 +1,42 @@
+/*
+* Losing Chess using matrix
+*
+* Author: Farhan Syed
+* Year: 2024
+
+  Evaluation tuner
+*/
+
+#include "Tuner.h"
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// Compiling:         g++ -O2 -pthread -o tune.exe tune.cpp Tuner.cpp TrainingData.cpp ChessBoard.cpp ChessPiece.cpp King.cpp Queen.cpp Rook.cpp Bishop.cpp Knight.cpp Pawn.cpp Fen.cpp PackedPosition.cpp MappedFile.cpp Zobrist.cpp Evaluation.cpp Nnue.cpp Random.cpp
+// Running:           ./tune.exe <output> <iterations> <threads> <index files...>
+//
+// The index files are written by datagen.exe. The tuned weights are written to output,
+// which main.cpp reads when it is called evaluation.txt.
+
+int main(int argc, char * argv[]) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0] << " <output> <iterations> <threads> <index files...>" << endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        TunerOptions options;
+        options.iterations = stoi(argv[2]);
+        TexelTuner tuner(stoi(argv[3]));
+        for (int i = 4; i < argc; i++) {
+            tuner.addIndex(argv[i]);
+        }
+        EvalParams tuned = tuner.tune(evalParams(), options, cout);
+        saveEvalParams(tuned, argv[1]);
+        cout << "Weights written to " << argv[1] << endl;
+    } catch (exception & error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}